@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * Wait-free single-producer/single-consumer ring of audio periods.
+ *
+ * In pipelined output (main.c --pipeline N) a render thread fills periods
+ * of interleaved stereo S16 ahead of time and the ALSA writer thread drains
+ * them, so a slow render call eats into the FIFO margin instead of causing
+ * an xrun. The producer renders in place into audio_fifo_write_slot() and
+ * publishes with audio_fifo_commit(); the consumer reads
+ * audio_fifo_read_slot() and frees it with audio_fifo_release().
+ *
+ * Same layout rules as midi_queue_t: head is only written by the producer,
+ * tail only by the consumer, each on its own 32-byte cache line.
+ */
+
+typedef struct {
+    int16_t *buf;                    // mask + 1 periods of stereo frames
+    uint32_t slots, period;          // FIFO depth and frames per period
+    uint32_t mask;                   // Storage is a power of two >= slots (counters wrap cleanly)
+    uint32_t head __attribute__((aligned(32)));  // Periods committed (producer)
+    uint32_t tail __attribute__((aligned(32)));  // Periods released (consumer)
+} audio_fifo_t;
+
+// Allocate a FIFO of slots periods; returns -1 on allocation failure
+static inline int audio_fifo_init(audio_fifo_t *f, uint32_t slots, uint32_t period){
+    uint32_t size = 1;
+    while(size < slots) size <<= 1;
+    f->buf = (int16_t *)calloc((size_t)size * period * 2, sizeof(int16_t));
+    if(!f->buf) return -1;
+    f->mask = size - 1;
+    f->slots = slots;
+    f->period = period;
+    __atomic_store_n(&f->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&f->tail, 0, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static inline void audio_fifo_free(audio_fifo_t *f){
+    free(f->buf);
+    f->buf = NULL;
+}
+
+// Periods ready to play (either side; a snapshot)
+static inline uint32_t audio_fifo_fill(audio_fifo_t *f){
+    return __atomic_load_n(&f->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&f->tail, __ATOMIC_ACQUIRE);
+}
+
+// Producer: the next free period to render into, or NULL if the FIFO is full
+static inline int16_t *audio_fifo_write_slot(audio_fifo_t *f){
+    uint32_t h = __atomic_load_n(&f->head, __ATOMIC_RELAXED);
+    uint32_t t = __atomic_load_n(&f->tail, __ATOMIC_ACQUIRE);
+    if(h - t >= f->slots) return NULL;
+    return f->buf + (size_t)(h & f->mask) * f->period * 2;
+}
+
+// Producer: publish the period returned by audio_fifo_write_slot()
+static inline void audio_fifo_commit(audio_fifo_t *f){
+    uint32_t h = __atomic_load_n(&f->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&f->head, h + 1, __ATOMIC_RELEASE);
+}
+
+// Consumer: the oldest rendered period, or NULL if the FIFO is empty
+static inline const int16_t *audio_fifo_read_slot(audio_fifo_t *f){
+    uint32_t t = __atomic_load_n(&f->tail, __ATOMIC_RELAXED);
+    uint32_t h = __atomic_load_n(&f->head, __ATOMIC_ACQUIRE);
+    if(t == h) return NULL;
+    return f->buf + (size_t)(t & f->mask) * f->period * 2;
+}
+
+// Consumer: free the period returned by audio_fifo_read_slot()
+static inline void audio_fifo_release(audio_fifo_t *f){
+    uint32_t t = __atomic_load_n(&f->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&f->tail, t + 1, __ATOMIC_RELEASE);
+}
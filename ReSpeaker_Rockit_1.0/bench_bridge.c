@@ -0,0 +1,435 @@
+/**
+ * MIDI bridge HTTP load generator
+ *
+ * Starts a midi_bridge binary on spare ports with an in-process MIDI sink
+ * upstream, then measures requests per second and per-request latency
+ * (p50/p99, from sending a request until its response is complete):
+ *   close       a new connection per request with "Connection: close" (how
+ *               the bridge served every request before keep-alive)
+ *   keepalive   one connection, one request at a time
+ *   pipeline    one connection, --pipeline requests per write
+ *   clients     --clients keep-alive connections at once, while one more
+ *               client sits on half a request the whole time
+ *   websocket   a CC per binary frame on one /ws socket; latency runs until
+ *               the bridge has pushed the frame to a second socket
+ *   ws/batch    --pipeline CCs per frame (what the web UI sends per
+ *               animation frame); rates count CC messages
+ * Every mode also checks that each request reached the sink as 3 bytes
+ * (websocket modes: each CC, sent with running status inside a frame and
+ * written out in full by the bridge).
+ *
+ * Build for the board with `make bench_bridge`, for the host with
+ * `make host/bench_bridge host/midi_bridge` and run
+ * `host/bench_bridge --bridge host/midi_bridge`.
+ *
+ * Usage: bench_bridge [--bridge PATH] [--requests N] [--clients N]
+ *                     [--pipeline N] [--port N] [--midi-port N] [--csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define CLOSE_MAX 1000          // Requests in close mode (each leaves a TIME_WAIT socket)
+#define MAX_CLIENTS 15          // The bridge's limit, less the stalled client
+#define MAX_PIPELINE 64
+#define WS_BATCH_MAX 41         // CCs per frame whose pushed copy (3 bytes each) fits a 125-byte payload
+#define SINK_CONNS 8
+
+static const char *bridge = "./midi_bridge";
+static uint16_t port = 50323, midi_port = 50324;
+static int requests = 20000;
+static uint32_t forwarded;      // Bytes the sink received
+static double *lat_us;          // Per-request latency of the current run
+static volatile int sink_running = 1;
+
+static double now_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Upstream stand-in for the synth: accepts the bridge and counts bytes
+static void *sink(void *arg){
+    int lfd = *(int *)arg;
+    struct pollfd pfd[1 + SINK_CONNS];
+    int n = 1;
+    pfd[0].fd = lfd;
+    pfd[0].events = POLLIN;
+    while(sink_running){
+        if(poll(pfd, n, 100) <= 0) continue;
+        if((pfd[0].revents & POLLIN) && n < 1 + SINK_CONNS){
+            int fd = accept(lfd, NULL, NULL);
+            if(fd >= 0){
+                pfd[n].fd = fd;
+                pfd[n].events = POLLIN;
+                pfd[n].revents = 0;
+                n++;
+            }
+        }
+        for(int i=1; i<n; i++){
+            if(!pfd[i].revents) continue;
+            char buf[4096];
+            ssize_t r = read(pfd[i].fd, buf, sizeof(buf));
+            if(r > 0){
+                __atomic_fetch_add(&forwarded, (uint32_t)r, __ATOMIC_RELAXED);
+                continue;
+            }
+            close(pfd[i].fd);
+            pfd[i--] = pfd[--n];
+        }
+    }
+    for(int i=0; i<n; i++) close(pfd[i].fd);
+    return NULL;
+}
+
+static int listen_on(uint16_t p){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(p);
+    if(fd < 0 || bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(fd, 4) < 0){
+        perror("sink");
+        return -1;
+    }
+    return fd;
+}
+
+static int connect_bridge(void){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0) return -1;
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(port);
+    struct timeval tv = { 2, 0 };   // A stalled server fails the run instead of hanging it
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if(connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0){
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// A client connection with a buffer of received, not yet parsed bytes
+typedef struct {
+    int fd;
+    char buf[8192];
+    size_t len;
+} conn_t;
+
+// Read one complete response; returns its status code, or -1 on EOF,
+// timeout or garbage
+static int read_response(conn_t *c){
+    for(;;){
+        c->buf[c->len] = '\0';
+        char *end = strstr(c->buf, "\r\n\r\n");
+        if(end){
+            size_t head = (size_t)(end + 4 - c->buf);
+            char *cl = strstr(c->buf, "Content-Length:");
+            size_t body = cl && cl < end ? (size_t)atoi(cl + 15) : 0;
+            if(c->len >= head + body){
+                int status = strncmp(c->buf, "HTTP/1.", 7) == 0 ? atoi(c->buf + 9) : -1;
+                memmove(c->buf, c->buf + head + body, c->len - head - body);
+                c->len -= head + body;
+                return status;
+            }
+        }
+        if(c->len == sizeof(c->buf) - 1) return -1;
+        ssize_t n = read(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len);
+        if(n <= 0) return -1;
+        c->len += (size_t)n;
+    }
+}
+
+static int format_request(char *out, size_t size, int i, int close_conn){
+    return snprintf(out, size, "GET /cc?cc=74&value=%d HTTP/1.1\r\nHost: bench\r\n%s\r\n",
+                    i & 0x7F, close_conn ? "Connection: close\r\n" : "");
+}
+
+static double run_close(int count){
+    double t0 = now_s();
+    for(int i=0; i<count; i++){
+        char req[128];
+        int len = format_request(req, sizeof(req), i, 1);
+        double t = now_s();
+        conn_t c = { connect_bridge(), "", 0 };
+        if(c.fd < 0) return -1.0;
+        int status = write(c.fd, req, (size_t)len) == len ? read_response(&c) : -1;
+        close(c.fd);
+        if(status != 200) return -1.0;
+        lat_us[i] = (now_s() - t) * 1e6;
+    }
+    return now_s() - t0;
+}
+
+typedef struct {
+    int first, count, depth;    // Requests [first, first+count), depth per write
+    int fail;
+} client_arg_t;
+
+static void *keepalive_client(void *arg){
+    client_arg_t *a = (client_arg_t *)arg;
+    conn_t c = { connect_bridge(), "", 0 };
+    if(c.fd < 0){
+        a->fail = 1;
+        return NULL;
+    }
+    for(int i=0; i<a->count && !a->fail; ){
+        char req[MAX_PIPELINE * 64];
+        int len = 0, n = a->count - i < a->depth ? a->count - i : a->depth;
+        for(int k=0; k<n; k++) len += format_request(req + len, sizeof(req) - (size_t)len, a->first + i + k, 0);
+        double t = now_s();
+        if(write(c.fd, req, (size_t)len) != len){
+            a->fail = 1;
+            break;
+        }
+        for(int k=0; k<n; k++, i++){
+            if(read_response(&c) != 200){
+                a->fail = 1;
+                break;
+            }
+            lat_us[a->first + i] = (now_s() - t) * 1e6;
+        }
+    }
+    close(c.fd);
+    return NULL;
+}
+
+static double run_keepalive(int clients, int count, int depth){
+    client_arg_t args[MAX_CLIENTS];
+    pthread_t th[MAX_CLIENTS];
+    double t0 = now_s();
+    for(int c=0; c<clients; c++){
+        args[c].first = c * (count / clients);
+        args[c].count = count / clients;
+        args[c].depth = depth;
+        args[c].fail = 0;
+        pthread_create(&th[c], NULL, keepalive_client, &args[c]);
+    }
+    int fail = 0;
+    for(int c=0; c<clients; c++){
+        pthread_join(th[c], NULL);
+        fail |= args[c].fail;
+    }
+    return fail ? -1.0 : now_s() - t0;
+}
+
+// Open a /ws socket (the accept key is not checked here: test_websocket does)
+static int ws_open(conn_t *c){
+    c->fd = connect_bridge();
+    c->len = 0;
+    const char *req = "GET /ws HTTP/1.1\r\nHost: bench\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if(c->fd < 0 || write(c->fd, req, strlen(req)) != (ssize_t)strlen(req) || read_response(c) != 101) return -1;
+    return 0;
+}
+
+// Read one server frame of up to 125 bytes; returns its payload length
+static int ws_read_frame(conn_t *c){
+    for(;;){
+        if(c->len >= 2 && c->len >= 2 + (size_t)(c->buf[1] & 0x7F)){
+            size_t n = 2 + (size_t)(c->buf[1] & 0x7F);
+            memmove(c->buf, c->buf + n, c->len - n);
+            c->len -= n;
+            return (int)n - 2;
+        }
+        ssize_t r = read(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len);
+        if(r <= 0) return -1;
+        c->len += (size_t)r;
+    }
+}
+
+// count CCs in frames of batch from one socket, each frame timed until it
+// reaches the other
+static double run_websocket(int count, int batch){
+    static conn_t tx, rx;
+    if(batch > WS_BATCH_MAX) batch = WS_BATCH_MAX;
+    if(ws_open(&tx) < 0 || ws_open(&rx) < 0){
+        if(tx.fd >= 0) close(tx.fd);
+        if(rx.fd >= 0) close(rx.fd);
+        return -1.0;
+    }
+    double t0 = now_s();
+    int fail = 0;
+    for(int i=0; i<count && !fail; ){
+        int n = count - i < batch ? count - i : batch;
+        size_t len = 1 + 2 * (size_t)n;
+        uint8_t frame[6 + 1 + WS_BATCH_MAX * 2] = { 0x82, (uint8_t)(0x80 | len) };  // Zero mask
+        frame[6] = 0xB0;                        // Running status after the first CC
+        for(int k=0; k<n; k++){
+            frame[7 + 2*k] = 74;
+            frame[8 + 2*k] = (uint8_t)((i + k) & 0x7F);
+        }
+        double t = now_s();
+        if(write(tx.fd, frame, 6 + len) != (ssize_t)(6 + len) || ws_read_frame(&rx) != 3 * n){
+            fail = 1;
+            break;
+        }
+        double lat = (now_s() - t) * 1e6;
+        for(int k=0; k<n; k++) lat_us[i++] = lat;
+    }
+    double secs = now_s() - t0;
+    close(tx.fd);
+    close(rx.fd);
+    return fail ? -1.0 : secs;
+}
+
+// Wait until bytes of MIDI reached the sink (or 2 s); returns how many
+// are missing
+static uint32_t wait_forwarded(uint32_t bytes){
+    double t0 = now_s();
+    while(__atomic_load_n(&forwarded, __ATOMIC_RELAXED) < bytes && now_s() - t0 < 2.0)
+        usleep(1000);
+    uint32_t got = __atomic_load_n(&forwarded, __ATOMIC_RELAXED);
+    return got < bytes ? bytes - got : 0;
+}
+
+static int cmp_double(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// count requests (or CCs) that should have sent bytes upstream
+static void report(int csv, const char *mode, int count, uint32_t bytes, double secs){
+    uint32_t missing = secs < 0 ? 0 : wait_forwarded(bytes);
+    if(secs < 0){
+        if(csv) printf("%s,%d,,,,,\n", mode, count);
+        else printf("  %-14s failed (refused, reset or timed out)\n", mode);
+        return;
+    }
+    qsort(lat_us, (size_t)count, sizeof(double), cmp_double);
+    double p50 = lat_us[count / 2], p99 = lat_us[(size_t)count * 99 / 100];
+    if(csv) printf("%s,%d,%.4f,%.0f,%.1f,%.1f,%u\n", mode, count, secs, count / secs, p50, p99, missing);
+    else printf("  %-14s %7d reqs %8.0f req/s   p50 %8.1f us   p99 %8.1f us%s\n",
+                mode, count, count / secs, p50, p99, missing ? "   (MIDI missing)" : "");
+}
+
+static pid_t start_bridge(void){
+    char p[16], mp[16];
+    snprintf(p, sizeof(p), "%u", port);
+    snprintf(mp, sizeof(mp), "%u", midi_port);
+    pid_t pid = fork();
+    if(pid == 0){
+        int null = open("/dev/null", O_WRONLY);
+        if(null >= 0) dup2(null, 2);
+        execl(bridge, bridge, "--port", p, "--midi-port", mp, (char *)NULL);
+        _exit(127);
+    }
+    for(int i=0; i<100; i++){       // Up to 2 s for it to listen
+        usleep(20000);
+        int fd = connect_bridge();
+        if(fd >= 0){
+            close(fd);
+            return pid;
+        }
+    }
+    kill(pid, SIGTERM);
+    return -1;
+}
+
+// SIGTERM, then SIGKILL for a bridge blocked where it cannot notice
+static void stop_bridge(pid_t pid){
+    kill(pid, SIGTERM);
+    for(int i=0; i<50; i++){
+        if(waitpid(pid, NULL, WNOHANG) == pid) return;
+        usleep(20000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr, "Usage: %s [--bridge PATH] [--requests N] [--clients N] [--pipeline N] "
+                    "[--port N] [--midi-port N] [--csv]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int clients = 4, depth = 16, csv = 0;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--bridge") == 0 && i+1 < argc) bridge = argv[++i];
+        else if(strcmp(argv[i], "--requests") == 0 && i+1 < argc) requests = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--clients") == 0 && i+1 < argc) clients = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--pipeline") == 0 && i+1 < argc) depth = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--port") == 0 && i+1 < argc) port = (uint16_t)atoi(argv[++i]);
+        else if(strcmp(argv[i], "--midi-port") == 0 && i+1 < argc) midi_port = (uint16_t)atoi(argv[++i]);
+        else if(strcmp(argv[i], "--csv") == 0) csv = 1;
+        else usage(argv[0]);
+    }
+    if(requests < 100 || clients < 1 || clients > MAX_CLIENTS || depth < 1 || depth > MAX_PIPELINE) usage(argv[0]);
+    signal(SIGPIPE, SIG_IGN);       // A bridge that hangs up shows as a failed write
+
+    lat_us = (double *)malloc(sizeof(double) * (size_t)requests);
+    int lfd = listen_on(midi_port);
+    if(!lat_us || lfd < 0) return 1;
+    pthread_t sink_th;
+    pthread_create(&sink_th, NULL, sink, &lfd);
+
+    pid_t pid = start_bridge();
+    if(pid < 0){
+        fprintf(stderr, "%s did not start listening on port %u\n", bridge, port);
+        return 1;
+    }
+
+    if(csv) printf("mode,requests,seconds,req_per_s,p50_us,p99_us,midi_bytes_missing\n");
+    else printf("MIDI bridge load (%s on 127.0.0.1:%u, sink on %u)\n", bridge, port, midi_port);
+
+    char mode[32];
+    int n = requests < CLOSE_MAX ? requests : CLOSE_MAX;
+    __atomic_store_n(&forwarded, 0, __ATOMIC_RELAXED);
+    report(csv, "close", n, (uint32_t)n * 3, run_close(n));
+
+    __atomic_store_n(&forwarded, 0, __ATOMIC_RELAXED);
+    report(csv, "keepalive", requests, (uint32_t)requests * 3, run_keepalive(1, requests, 1));
+
+    snprintf(mode, sizeof(mode), "pipeline/%d", depth);
+    __atomic_store_n(&forwarded, 0, __ATOMIC_RELAXED);
+    report(csv, mode, requests, (uint32_t)requests * 3, run_keepalive(1, requests, depth));
+
+    // The stalled client connects first and never finishes its request
+    int stalled = connect_bridge();
+    if(stalled >= 0 && write(stalled, "GET /cc?cc=7", 12) != 12){
+        close(stalled);
+        stalled = -1;
+    }
+    snprintf(mode, sizeof(mode), "clients/%d+1", clients);
+    __atomic_store_n(&forwarded, 0, __ATOMIC_RELAXED);
+    n = requests / clients * clients;
+    report(csv, mode, n, (uint32_t)n * 3, run_keepalive(clients, requests, 1));
+    if(stalled >= 0) close(stalled);
+
+    __atomic_store_n(&forwarded, 0, __ATOMIC_RELAXED);
+    report(csv, "websocket", requests, (uint32_t)requests * 3, run_websocket(requests, 1));
+
+    int batch = depth < WS_BATCH_MAX ? depth : WS_BATCH_MAX;
+    snprintf(mode, sizeof(mode), "ws/batch%d", batch);
+    __atomic_store_n(&forwarded, 0, __ATOMIC_RELAXED);
+    report(csv, mode, requests, (uint32_t)requests * 3, run_websocket(requests, batch));
+
+    stop_bridge(pid);
+    sink_running = 0;
+    pthread_join(sink_th, NULL);
+    free(lat_us);
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * MIDI socket throughput benchmark
+ *
+ * Runs the socket_midi_raw server in-process and measures how many
+ * messages per second reach its callbacks:
+ *   connect   one connection per 3-byte message (how clients had to talk
+ *             to the server before it kept connections open)
+ *   stream    one persistent connection, a write() per message
+ *   running   the same with running status (2 bytes per note)
+ *   clients   --clients persistent connections streaming at once
+ *   udp       a datagram per message to the UDP port, then --batch
+ *             messages packed per datagram
+ *   unix      the same through the AF_UNIX datagram socket
+ * Timing runs from the first write until the server has dispatched the
+ * last message. UDP drops datagrams when the server falls behind; lost
+ * messages are reported and rates count delivered messages only.
+ *
+ * Build for the board with `make bench_midi`, for the host with
+ * `make host/bench_midi`.
+ *
+ * Usage: bench_midi [--messages N] [--clients N] [--batch N] [--port N] [--csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "socket_midi_raw.h"
+
+#define MAX_CLIENTS 8           // The server's limit
+#define CONNECT_MAX 1000        // Messages in connect mode (each leaves a TIME_WAIT socket)
+#define UNIX_PATH "/tmp/bench_midi.sock"
+
+static uint16_t port = 50322;
+static int messages = 100000;
+static uint32_t received;
+static uint32_t lost;           // Messages of the last run that never arrived
+
+static void on_note_on(uint8_t note){ (void)note; __atomic_fetch_add(&received, 1, __ATOMIC_RELAXED); }
+static void on_note_off(uint8_t note){ (void)note; __atomic_fetch_add(&received, 1, __ATOMIC_RELAXED); }
+static void on_cc(uint8_t cc, uint8_t value){ (void)cc; (void)value; __atomic_fetch_add(&received, 1, __ATOMIC_RELAXED); }
+
+static double now_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int connect_server(void){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0) return -1;
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(port);
+    struct timeval tv = { 2, 0 };   // Bounds connect(): fail rather than hang
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if(connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0){
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));    // A live controller: no coalescing
+    return fd;
+}
+
+// Wait (yielding: the server may share the core) until count messages
+// arrived, or nothing more has for 0.5 s; returns the time of the last
+// arrival, and the shortfall in lost
+static double wait_received(uint32_t count){
+    uint32_t seen = __atomic_load_n(&received, __ATOMIC_RELAXED);
+    double last = now_s();
+    while(seen < count){
+        sched_yield();
+        uint32_t r = __atomic_load_n(&received, __ATOMIC_RELAXED);
+        if(r != seen){
+            seen = r;
+            last = now_s();
+        } else if(now_s() - last > 0.5){
+            break;
+        }
+    }
+    lost = count - seen;
+    return seen ? last : -1.0;
+}
+
+typedef struct {
+    int count;
+    int running_status;
+    int fail;
+} stream_arg_t;
+
+static void *stream_client(void *arg){
+    stream_arg_t *s = (stream_arg_t *)arg;
+    int fd = connect_server();
+    if(fd < 0){
+        s->fail = 1;
+        return NULL;
+    }
+    for(int i=0; i<s->count; i++){
+        uint8_t msg[3] = { 0x90, (uint8_t)(i & 0x7F), (uint8_t)(i & 1 ? 0 : 100) };
+        int first = s->running_status && i > 0;     // Status byte only on the first message
+        if(write(fd, msg + first, (size_t)(3 - first)) != 3 - first){
+            s->fail = 1;
+            break;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static double run_connect(int count){
+    double t0 = now_s();
+    for(int i=0; i<count; i++){
+        uint8_t msg[3] = { 0xB0, 74, (uint8_t)(i & 0x7F) };
+        int fd = connect_server();
+        if(fd < 0 || write(fd, msg, 3) != 3){
+            if(fd >= 0) close(fd);
+            return -1.0;
+        }
+        close(fd);
+    }
+    double t1 = wait_received((uint32_t)count);
+    return t1 < 0 ? -1.0 : t1 - t0;
+}
+
+static double run_streams(int clients, int count, int running_status){
+    stream_arg_t args[MAX_CLIENTS];
+    pthread_t th[MAX_CLIENTS];
+    double t0 = now_s();
+    for(int c=0; c<clients; c++){
+        args[c].count = count / clients;
+        args[c].running_status = running_status;
+        args[c].fail = 0;
+        pthread_create(&th[c], NULL, stream_client, &args[c]);
+    }
+    int fail = 0;
+    for(int c=0; c<clients; c++){
+        pthread_join(th[c], NULL);
+        fail |= args[c].fail;
+    }
+    if(fail) return -1.0;
+    double t1 = wait_received((uint32_t)(count / clients * clients));
+    return t1 < 0 ? -1.0 : t1 - t0;
+}
+
+// count note messages in datagrams of batch messages (running status)
+static double run_datagrams(int is_unix, int count, int batch){
+    int fd = socket(is_unix ? AF_UNIX : AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in in;
+    struct sockaddr_un un;
+    memset(&in, 0, sizeof(in));
+    in.sin_family = AF_INET;
+    in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    in.sin_port = htons(port);
+    memset(&un, 0, sizeof(un));
+    un.sun_family = AF_UNIX;
+    strcpy(un.sun_path, UNIX_PATH);
+    if(fd < 0 || connect(fd, is_unix ? (struct sockaddr *)&un : (struct sockaddr *)&in,
+                         is_unix ? sizeof(un) : sizeof(in)) < 0){
+        if(fd >= 0) close(fd);
+        return -1.0;
+    }
+    uint8_t buf[1 + 512 * 2];
+    double t0 = now_s();
+    for(int i=0; i<count; ){
+        size_t n = 0;
+        buf[n++] = 0x90;
+        for(int m=0; m<batch && i<count; m++, i++){
+            buf[n++] = (uint8_t)(i & 0x7F);
+            buf[n++] = (uint8_t)(i & 1 ? 0 : 100);
+        }
+        if(send(fd, buf, n, 0) < 0){
+            close(fd);
+            return -1.0;
+        }
+    }
+    close(fd);
+    double t1 = wait_received((uint32_t)count);
+    return t1 < 0 ? -1.0 : t1 - t0;
+}
+
+static void report(int csv, const char *mode, int count, double secs){
+    if(secs < 0){
+        if(csv) printf("%s,%d,,,\n", mode, count);
+        else printf("  %-16s failed (connection refused or timed out)\n", mode);
+        return;
+    }
+    int got = count - (int)lost;
+    if(csv) printf("%s,%d,%.4f,%.0f,%u\n", mode, count, secs, got / secs, lost);
+    else if(lost) printf("  %-16s %8d msgs %9.0f msgs/s %8.2f us/msg  (%u lost)\n", mode, count, got / secs, secs * 1e6 / got, lost);
+    else printf("  %-16s %8d msgs %9.0f msgs/s %8.2f us/msg\n", mode, count, got / secs, secs * 1e6 / got);
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr, "Usage: %s [--messages N] [--clients N] [--batch N] [--port N] [--csv]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int clients = 4, batch = 32, csv = 0;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--messages") == 0 && i+1 < argc) messages = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--clients") == 0 && i+1 < argc) clients = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--batch") == 0 && i+1 < argc) batch = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--port") == 0 && i+1 < argc) port = (uint16_t)atoi(argv[++i]);
+        else if(strcmp(argv[i], "--csv") == 0) csv = 1;
+        else usage(argv[0]);
+    }
+    if(messages < 1 || clients < 1 || clients > MAX_CLIENTS || batch < 1 || batch > 512) usage(argv[0]);
+    signal(SIGPIPE, SIG_IGN);       // A server that hangs up shows as a failed write
+
+    socket_midi_raw_set_datagram(port, UNIX_PATH);
+    if(socket_midi_raw_start(port, on_note_on, on_note_off, on_cc) < 0) return 1;
+    usleep(100000);     // Let the server bind
+
+    if(csv) printf("mode,messages,seconds,msgs_per_s,lost\n");
+    else printf("MIDI socket throughput (127.0.0.1:%u, %s)\n", port, UNIX_PATH);
+
+    char mode[32];
+    int n = messages < CONNECT_MAX ? messages : CONNECT_MAX;
+    __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+    report(csv, "connect", n, run_connect(n));
+
+    __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+    report(csv, "stream", messages, run_streams(1, messages, 0));
+
+    __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+    report(csv, "running", messages, run_streams(1, messages, 1));
+
+    snprintf(mode, sizeof(mode), "clients/%d", clients);
+    __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+    report(csv, mode, messages / clients * clients, run_streams(clients, messages, 0));
+
+    for(int u=0; u<2; u++){
+        const char *name = u ? "unix" : "udp";
+        __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+        report(csv, name, messages, run_datagrams(u, messages, 1));
+        snprintf(mode, sizeof(mode), "%s/batch%d", name, batch);
+        __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+        report(csv, mode, messages, run_datagrams(u, messages, batch));
+    }
+
+    socket_midi_raw_stop();
+    return 0;
+}
@@ -0,0 +1,291 @@
+/**
+ * Rockit benchmark suite
+ *
+ * Times each DSP kernel in isolation, then the whole engine:
+ *   osc     every wave_t through osc_render_block() at three notes, plus the
+ *           HQ and PolyBLEP variants of the shapes those engines replace
+ *   lfo     the 16 LFO shapes (lfo_wave() and a phase step, per call)
+ *   svf     the 4 filter modes, float and fixed-point kernels
+ *   engine  rockit_engine_render() for typical patches (per stereo frame)
+ *
+ * Cycles come from the CP0 Count register on MIPS32r2 (rdhwr $2, scaled by
+ * the CCRes divider); elsewhere, or when --mhz is given, they are estimated
+ * from clock_gettime() at that clock (580 MHz, the MT7688, by default).
+ * Count is 32 bits and wraps after ~15 s at 580 MHz, so keep --seconds small.
+ * --csv prints one line per measurement for diffing between builds:
+ *   suite,kernel,variant,unit,ns,cycles
+ *
+ * Build for the board with `make bench_rockit`, for the host with
+ * `make host/bench_rockit`.
+ *
+ * Usage: bench_rockit [--seconds N] [--mhz N] [--csv] [--only osc|lfo|svf|engine]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "rockit_engine.h"
+
+#define SR 48000
+#define BLOCK 32            // Oscillator block (the engine's control block)
+#define PERIOD 256          // Engine render call
+
+#if defined(__mips__) && defined(__mips_isa_rev) && __mips_isa_rev >= 2
+#define HAVE_CP0_COUNT 1
+static inline uint32_t cp0_count(void){
+    uint32_t c;
+    __asm__ __volatile__("rdhwr %0, $2" : "=r"(c));
+    return c;
+}
+static inline uint32_t cp0_count_res(void){
+    uint32_t r;
+    __asm__ __volatile__("rdhwr %0, $3" : "=r"(r));
+    return r;
+}
+#endif
+
+static const char *WAVE_NAMES[16] = {
+    "sine", "square", "saw", "tri", "morph1", "morph2", "morph3", "morph4",
+    "morph5", "morph6", "morph7", "morph8", "morph9", "hardsync", "noise", "rawsq",
+};
+static const char *ENGINE_NAMES[3] = { "classic", "hq", "blep" };
+static const char *MODE_NAMES[4] = { "lp", "bp", "hp", "notch" };
+static const uint8_t NOTES[] = { 36, 60, 96 };
+
+static double seconds = 1.0;
+static double mhz = 580.0;
+static int use_count = 0;   // Cycles from CP0 Count instead of time * mhz
+static int csv = 0;
+static volatile int32_t sink;
+
+typedef struct {
+    double t0;
+#ifdef HAVE_CP0_COUNT
+    uint32_t c0;
+#endif
+} bench_timer_t;
+
+static double now_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void timer_start(bench_timer_t *t){
+#ifdef HAVE_CP0_COUNT
+    t->c0 = cp0_count();
+#endif
+    t->t0 = now_s();
+}
+
+// Stop the timer and print one result; n is the number of units timed
+static void report(bench_timer_t *t, const char *suite, const char *kernel,
+                   const char *variant, const char *unit, size_t n){
+    double ns = (now_s() - t->t0) * 1e9 / (double)n;
+    double cyc = ns * mhz / 1000.0;
+#ifdef HAVE_CP0_COUNT
+    if(use_count) cyc = (double)(uint32_t)(cp0_count() - t->c0) * cp0_count_res() / (double)n;
+#endif
+    if(csv) printf("%s,%s,%s,%s,%.3f,%.1f\n", suite, kernel, variant, unit, ns, cyc);
+    else printf("  %-10s %-12s %9.2f ns/%-6s %8.1f cyc\n", kernel, variant, ns, unit, cyc);
+}
+
+static void heading(const char *title){
+    if(!csv) printf("\n%s\n", title);
+}
+
+// Same increment the engine computes for a note (A4 = 440 Hz)
+static uint32_t note_inc(uint8_t note){
+    double hz = 440.0 * pow(2.0, (note - 69) / 12.0);
+    return (uint32_t)(hz * 4294967296.0 / SR);
+}
+
+// Engines other than classic only change these shapes (see osc_render_block)
+static int engine_applies(int engine, wave_t w){
+    if(engine == OSC_ENGINE_HQ) return w <= W_TRI;
+    if(engine == OSC_ENGINE_BLEP) return w == W_SQUARE || w == W_SAW || w == W_TRI || w == W_RAW_SQUARE;
+    return 1;
+}
+
+static void bench_osc(void){
+    static osc_cache_t cache;
+    static int16_t out[BLOCK];
+    size_t samples = (size_t)(seconds * SR);
+    osc_hq_init();
+    osc_cache_init(&cache);
+
+    heading("Oscillators (osc_render_block, per sample)");
+    for(int w=0; w<16; w++){
+        for(int e=0; e<3; e++){
+            if(!engine_applies(e, (wave_t)w)) continue;
+            for(size_t ni=0; ni<sizeof(NOTES); ni++){
+                osc_tables_t tabs;
+                morph_state_t morph;
+                memset(&morph, 0, sizeof(morph));
+                morph.lfsr = 0xACE1;
+                osc_tables_bind(&tabs, &cache, NOTES[ni]);
+                uint32_t ph = 0, inc = note_inc(NOTES[ni]);
+                uint32_t width = osc_pulse_width(64);
+
+                bench_timer_t t;
+                timer_start(&t);
+                for(size_t done=0; done<samples; done+=BLOCK){
+                    osc_render_block(out, BLOCK, &ph, inc, (osc_engine_t)e, width, (wave_t)w, &tabs, &morph, ENV_SUSTAIN);
+                    sink += out[BLOCK-1];
+                }
+                char variant[24];
+                snprintf(variant, sizeof(variant), "%s/%d", ENGINE_NAMES[e], NOTES[ni]);
+                report(&t, "osc", WAVE_NAMES[w], variant, "sample", samples);
+            }
+        }
+    }
+}
+
+static void bench_lfo(void){
+    // Many more calls than the engine makes (one per control block) so the
+    // timer resolution does not matter
+    size_t calls = (size_t)(seconds * SR);
+
+    heading("LFO shapes (lfo_wave, per call)");
+    for(int s=0; s<16; s++){
+        lfo_t l = { 0, note_inc(60) >> 4, (uint8_t)s, 0, 0xACE1 };
+        bench_timer_t t;
+        timer_start(&t);
+        for(size_t i=0; i<calls; i++){
+            sink += lfo_wave(&l);
+            l.ph += l.inc;
+        }
+        report(&t, "lfo", WAVE_NAMES[s], "-", "call", calls);
+    }
+}
+
+static void bench_svf(void){
+    static int16_t in[PERIOD];
+    size_t samples = (size_t)(seconds * SR);
+
+    // Saw input at a mid cutoff with some resonance
+    uint32_t ph = 0, inc = note_inc(48);
+    for(int i=0; i<PERIOD; i++, ph += inc) in[i] = (int16_t)((int32_t)(ph >> 16) - 32768);
+
+    heading("Filter modes (SVF, per sample)");
+    for(int fixed=0; fixed<2; fixed++){
+        for(int m=0; m<4; m++){
+            static svf_t f;
+            svf_init(&f, SR);
+            svf_set_cutoff_param(&f, 70 << 8);
+            svf_set_res_param(&f, 90 << 8);
+            svf_update_fixed(&f);
+
+            bench_timer_t t;
+            timer_start(&t);
+            if(fixed){
+                int32_t acc = 0;
+                for(size_t done=0; done<samples; done+=PERIOD){
+                    for(int i=0; i<PERIOD; i++){
+                        int32_t x = (int32_t)in[i] << 8;
+                        switch(m){
+                            case 0: acc += svf_fx_process_lp(&f, x); break;
+                            case 1: acc += svf_fx_process_bp(&f, x); break;
+                            case 2: acc += svf_fx_process_hp(&f, x); break;
+                            default: acc += svf_fx_process_notch(&f, x); break;
+                        }
+                    }
+                }
+                sink += acc;
+            } else {
+                float acc = 0.0f;
+                for(size_t done=0; done<samples; done+=PERIOD){
+                    for(int i=0; i<PERIOD; i++){
+                        float x = (float)in[i] / 32768.0f;
+                        switch(m){
+                            case 0: acc += svf_process_lp(&f, x); break;
+                            case 1: acc += svf_process_bp(&f, x); break;
+                            case 2: acc += svf_process_hp(&f, x); break;
+                            default: acc += svf_process_notch(&f, x); break;
+                        }
+                    }
+                }
+                sink += (int32_t)acc;
+            }
+            report(&t, "svf", MODE_NAMES[m], fixed ? "fixed" : "float", "sample", samples);
+        }
+    }
+}
+
+// Typical patches as the CC messages a controller would send
+static const struct {
+    const char *name;
+    uint8_t cc[12][2];      // Zero-terminated
+    uint8_t notes[3];       // Zero = unused
+} PATCHES[] = {
+    { "init-chord",  { { 0, 0 } },                                            { 48, 55, 60 } },
+    { "saw-lp-res",  { { 80, 2 << 3 }, { 81, 2 << 3 }, { 74, 40 }, { 71, 100 },
+                       { 85, 80 }, { 82, 66 }, { 0, 0 } },                    { 45, 0, 0 } },
+    { "morph-lfo",   { { 80, 7 << 3 }, { 81, 11 << 3 }, { 87, 60 }, { 1, 100 },
+                       { 89, 1 << 4 }, { 95, 20 }, { 96, 80 }, { 0, 0 } },   { 48, 52, 55 } },
+    { "hq-glide",    { { 83, 64 }, { 80, 2 << 3 }, { 81, 3 << 3 }, { 82, 70 },
+                       { 90, 60 }, { 84, 1 }, { 0, 0 } },                     { 40, 47, 52 } },
+    { "blep-pwm",    { { 83, 127 }, { 80, 15 << 3 }, { 81, 2 << 3 }, { 87, 40 },
+                       { 1, 90 }, { 89, 96 }, { 0, 0 } },                     { 36, 43, 48 } },
+};
+
+static void bench_engine(void){
+    static rockit_engine_t e;
+    static int16_t out[PERIOD * 2];
+    size_t frames = (size_t)(seconds * SR);
+
+    heading("Engine (rockit_engine_render, per stereo frame)");
+    for(size_t p=0; p<sizeof(PATCHES)/sizeof(PATCHES[0]); p++){
+        rockit_engine_init(&e);
+        for(int c=0; c<12 && PATCHES[p].cc[c][0]; c++)
+            rockit_handle_cc(&e, PATCHES[p].cc[c][0], PATCHES[p].cc[c][1]);
+        for(int n=0; n<3; n++)
+            if(PATCHES[p].notes[n]) rockit_note_on(&e, PATCHES[p].notes[n]);
+
+        // Past the attack, and every derived value built
+        for(int i=0; i<SR / PERIOD / 4; i++) rockit_engine_render(&e, out, PERIOD, SR);
+
+        bench_timer_t t;
+        timer_start(&t);
+        for(size_t done=0; done<frames; done+=PERIOD){
+            rockit_engine_render(&e, out, PERIOD, SR);
+            sink += out[0];
+        }
+        report(&t, "engine", PATCHES[p].name, "-", "frame", frames);
+    }
+}
+
+static int usage(const char *argv0){
+    fprintf(stderr, "Usage: %s [--seconds N] [--mhz N] [--csv] [--only osc|lfo|svf|engine]\n", argv0);
+    return 1;
+}
+
+int main(int argc, char **argv){
+    const char *only = NULL;
+    int mhz_given = 0;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--seconds") == 0 && i+1 < argc) seconds = atof(argv[++i]);
+        else if(strcmp(argv[i], "--mhz") == 0 && i+1 < argc){ mhz = atof(argv[++i]); mhz_given = 1; }
+        else if(strcmp(argv[i], "--csv") == 0) csv = 1;
+        else if(strcmp(argv[i], "--only") == 0 && i+1 < argc) only = argv[++i];
+        else return usage(argv[0]);
+    }
+    if(seconds <= 0.0 || mhz <= 0.0) return usage(argv[0]);
+#ifdef HAVE_CP0_COUNT
+    use_count = !mhz_given;
+#else
+    (void)mhz_given;
+#endif
+
+    if(csv) printf("suite,kernel,variant,unit,ns,cycles\n");
+    else if(use_count) printf("Rockit benchmarks (%.2f s each, cycles from CP0 Count)\n", seconds);
+    else printf("Rockit benchmarks (%.2f s each, cycles estimated @ %.0f MHz)\n", seconds, mhz);
+
+    if(!only || strcmp(only, "osc") == 0) bench_osc();
+    if(!only || strcmp(only, "lfo") == 0) bench_lfo();
+    if(!only || strcmp(only, "svf") == 0) bench_svf();
+    if(!only || strcmp(only, "engine") == 0) bench_engine();
+    return 0;
+}
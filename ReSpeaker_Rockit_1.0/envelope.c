@@ -0,0 +1,13 @@
+#include "envelope.h"
+
+void env_table_init(env_table_t *t, int sr){
+    // Knob 0 is instant: one step covers full scale
+    t->rate[0] = (uint32_t)ENV_FULL;
+    for(int k=1; k<128; k++){
+        // k/127 * 2000 ms worth of samples
+        uint32_t samples = (uint32_t)(((uint64_t)k * 2 * (uint32_t)sr) / 127);
+        if(samples < 1) samples = 1;
+        t->rate[k] = (uint32_t)ENV_FULL / samples;
+        if(t->rate[k] < 1) t->rate[k] = 1;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdint.h>
+
+// Envelope states
+typedef enum { ENV_IDLE=0, ENV_ATTACK, ENV_DECAY, ENV_SUSTAIN, ENV_RELEASE } env_t;
+
+/*
+ * Division-free ADSR (same curve shapes as amp_adsr.c in Rockit 1.13).
+ *
+ * The original moves the level by a fixed step every few timer ticks, so
+ * every stage is a straight line whose slope is set by its knob: attack
+ * starts from wherever the level is, decay falls at its own rate until it
+ * meets sustain, and release falls from the current level at a fixed rate
+ * (a quieter note releases sooner). Here the level is Q30 and each stage
+ * adds or subtracts a per-sample slope looked up from an env_table_t, which
+ * is rebuilt only when the sample rate changes. rate[k] covers full scale
+ * in k/127 * 2 s, matching the knob range of earlier releases.
+ */
+
+#define ENV_SHIFT 15                         // Q30 level >> 15 = Q15 output
+#define ENV_FULL  ((int32_t)32767 << ENV_SHIFT)
+
+typedef struct {
+    uint32_t atk, dec, rel;                  // Slopes: Q30 per sample
+    int32_t sus;                             // Sustain level (Q30)
+} env_rates_t;
+
+// Per-sample slope for each knob position at one sample rate
+typedef struct {
+    uint32_t rate[128];
+} env_table_t;
+
+void env_table_init(env_table_t *t, int sr);
+
+// Sustain knob (0-127) as a Q30 level, equal to the old Q15 sustain << 15
+static inline int32_t env_sustain_level(int knob){
+    return (int32_t)((knob & 0x7F) * 32767 / 127) << ENV_SHIFT;
+}
+
+// Advance the envelope by one sample; returns the new Q30 level.
+// *stage becomes ENV_IDLE when the release reaches zero.
+static inline int32_t env_step(int32_t lvl, uint8_t *stage, const env_rates_t *r){
+    switch(*stage){
+        case ENV_ATTACK:
+            lvl += (int32_t)r->atk;
+            if(lvl >= ENV_FULL){
+                lvl = ENV_FULL;
+                *stage = ENV_DECAY;
+            }
+            break;
+        case ENV_DECAY:
+            lvl -= (int32_t)r->dec;
+            if(lvl <= r->sus){
+                lvl = r->sus;
+                *stage = ENV_SUSTAIN;
+            }
+            break;
+        case ENV_SUSTAIN:
+            lvl = r->sus;
+            break;
+        case ENV_RELEASE:
+            lvl -= (int32_t)r->rel;
+            if(lvl <= 0){
+                lvl = 0;
+                *stage = ENV_IDLE;
+            }
+            break;
+        default:
+            lvl = 0;
+            *stage = ENV_IDLE;
+            break;
+    }
+    return lvl;
+}
@@ -1,20 +1,63 @@
-
 #include "filter_svf.h"
 #include <math.h>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
+
+static float cutoff_to_g(float hz, int sample_rate){
+  if(hz < 10.0f) hz = 10.0f;
+  float nyq = 0.45f * (float)sample_rate;
+  if(hz > nyq) hz = nyq;
+  return tanf((float)M_PI * hz / (float)sample_rate);
+}
+
+static float q_to_k(float Q){
+  if(Q < 0.3f) Q = 0.3f;
+  if(Q > 20.0f) Q = 20.0f;
+  return 1.0f / Q;
+}
+
+static int32_t to_fixed(float x, float scale){
+  float v = x * scale;
+  if(v >= 2147483647.0f) return 2147483647;
+  if(v <= 0.0f) return 0;
+  return (int32_t)v;
+}
+
+void svf_update_fixed(svf_t* f){
+  // One reciprocal per coefficient change instead of a division per sample
+  float a1 = 1.0f / (1.0f + f->g * (f->g + f->k));
+  float a2 = f->g * a1;
+  f->a1_q31 = to_fixed(a1, 2147483648.0f);
+  f->a2_q31 = to_fixed(a2, 2147483648.0f);
+  f->a3_q31 = to_fixed(f->g * a2, 2147483648.0f);
+  f->k_q29 = to_fixed(f->k, 536870912.0f);
+}
+
 void svf_init(svf_t* f, int sample_rate){
   f->ic1eq=0.0f; f->ic2eq=0.0f; f->g=0.0f; f->k=1.0f; f->sample_rate=sample_rate>0?sample_rate:48000;
+  f->s1=0; f->s2=0;
+
+  // Exponential knob curve like original Rockit: 20Hz * 1000^(knob/127)
+  for(int i=0; i<=SVF_CUTOFF_STEPS; i++){
+    float knob = (float)i * 0.5f;
+    f->g_tab[i] = cutoff_to_g(20.0f * powf(1000.0f, knob / 127.0f), f->sample_rate);
+  }
+  // Linear Q curve: 0.5 + knob/127 * 19.5
+  for(int i=0; i<=SVF_RES_STEPS; i++){
+    f->k_tab[i] = q_to_k(0.5f + ((float)i / 127.0f) * 19.5f);
+  }
+  svf_update_fixed(f);
 }
 void svf_set_cutoff(svf_t* f, float hz){
-  if(hz < 10.0f) hz = 10.0f;
-  float nyq = 0.45f * (float)f->sample_rate;
-  if(hz > nyq) hz = nyq;
-  f->g = tanf((float)M_PI * hz / (float)f->sample_rate);
+  f->g = cutoff_to_g(hz, f->sample_rate);
+#ifdef ROCKIT_SVF_FIXED
+  svf_update_fixed(f);
+#endif
 }
 void svf_set_q(svf_t* f, float Q){
-  if(Q < 0.3f) Q = 0.3f;
-  if(Q > 20.0f) Q = 20.0f;
-  f->k = 1.0f / Q;
+  f->k = q_to_k(Q);
+#ifdef ROCKIT_SVF_FIXED
+  svf_update_fixed(f);
+#endif
 }
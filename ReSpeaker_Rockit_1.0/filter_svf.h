@@ -1,10 +1,49 @@
-
 #pragma once
 #include <stdint.h>
-typedef struct { float ic1eq, ic2eq; float g, k; int sample_rate; } svf_t;
+
+// Coefficient tables, built once per sample rate in svf_init().
+// Cutoff is addressed on the engine's exponential 20Hz-20kHz knob scale
+// as a Q8 parameter position (0..127<<8), two table steps per knob unit.
+// Resonance is addressed as a Q8 knob position mapping to Q 0.5-20.
+#define SVF_CUTOFF_STEPS 256
+#define SVF_RES_STEPS 128
+
+typedef struct {
+  float ic1eq, ic2eq; float g, k; int sample_rate;
+  float g_tab[SVF_CUTOFF_STEPS + 1];  // g = tan(pi*fc/fs) per cutoff step
+  float k_tab[SVF_RES_STEPS + 1];     // k = 1/Q per resonance step
+  // Fixed-point variant (ROCKIT_SVF_FIXED): Q31 coefficients with the
+  // 1/(1+g(g+k)) reciprocal folded in, Q8.23 state (int16 << 8 = 8 bits headroom)
+  int32_t a1_q31, a2_q31, a3_q31, k_q29;
+  int32_t s1, s2;
+} svf_t;
 void svf_init(svf_t* f, int sample_rate);
 void svf_set_cutoff(svf_t* f, float hz);
 void svf_set_q(svf_t* f, float Q);
+void svf_update_fixed(svf_t* f);  // Recompute fixed-point coefficients from g/k
+
+// Table lookup with linear interpolation - no tanf/powf in the render path
+static inline void svf_set_cutoff_param(svf_t* f, int32_t pos_q8){
+  if(pos_q8 < 0) pos_q8 = 0;
+  if(pos_q8 > (SVF_CUTOFF_STEPS << 7) - 1) pos_q8 = (SVF_CUTOFF_STEPS << 7) - 1;
+  int32_t i = pos_q8 >> 7;
+  float frac = (float)(pos_q8 & 0x7F) * (1.0f / 128.0f);
+  f->g = f->g_tab[i] + (f->g_tab[i + 1] - f->g_tab[i]) * frac;
+#ifdef ROCKIT_SVF_FIXED
+  svf_update_fixed(f);
+#endif
+}
+
+static inline void svf_set_res_param(svf_t* f, int32_t pos_q8){
+  if(pos_q8 < 0) pos_q8 = 0;
+  if(pos_q8 > (SVF_RES_STEPS << 8) - 1) pos_q8 = (SVF_RES_STEPS << 8) - 1;
+  int32_t i = pos_q8 >> 8;
+  float frac = (float)(pos_q8 & 0xFF) * (1.0f / 256.0f);
+  f->k = f->k_tab[i] + (f->k_tab[i + 1] - f->k_tab[i]) * frac;
+#ifdef ROCKIT_SVF_FIXED
+  svf_update_fixed(f);
+#endif
+}
 
 // SVF filter modes - all use same state update
 static inline float svf_process_lp(svf_t* f, float v0){
@@ -38,3 +77,66 @@ static inline float svf_process_notch(svf_t* f, float v0){
   f->ic2eq = 2.0f * v2 - f->ic2eq;
   return v0 - f->k * v1;  // Notch output (v0 - BP)
 }
+
+// ==== FIXED-POINT SVF (build with -DROCKIT_SVF_FIXED) ====
+// Same topology as above in the a1/a2/a3 form:
+//   v3 = v0 - ic2; v1 = a1*ic1 + a2*v3; v2 = ic2 + a2*ic1 + a3*v3
+// with a1 = 1/(1+g(g+k)), a2 = g*a1, a3 = g*a2 all in [0,1) as Q31, so the
+// per-sample division disappears. Signals are Q8.23 (int16 sample << 8),
+// leaving 8 bits of headroom for resonant peaks (up to Q=20).
+// On MIPS the products go through the DSP ASE accumulators (mult/madd +
+// extr_rs.w round/saturate) and saturating addq_s.w/subq_s.w.
+#if defined(__mips_dsp)
+typedef long long svf_acc_t;
+#define svf_mult(a, b)         __builtin_mips_mult((a), (b))
+#define svf_madd(acc, a, b)    __builtin_mips_madd((acc), (a), (b))
+#define svf_extr_rs(acc, s)    __builtin_mips_extr_rs_w((acc), (s))
+#define svf_addq_s(a, b)       __builtin_mips_addq_s_w((a), (b))
+#define svf_subq_s(a, b)       __builtin_mips_subq_s_w((a), (b))
+#else
+// Portable equivalents (host builds, tests)
+typedef int64_t svf_acc_t;
+static inline int32_t svf_sat32(int64_t x){
+  if(x > 2147483647LL) return 2147483647;
+  if(x < -2147483648LL) return (int32_t)-2147483648LL;
+  return (int32_t)x;
+}
+#define svf_mult(a, b)         ((int64_t)(a) * (int64_t)(b))
+#define svf_madd(acc, a, b)    ((acc) + (int64_t)(a) * (int64_t)(b))
+#define svf_extr_rs(acc, s)    svf_sat32(((acc) + (1LL << ((s) - 1))) >> (s))
+#define svf_addq_s(a, b)       svf_sat32((int64_t)(a) + (int64_t)(b))
+#define svf_subq_s(a, b)       svf_sat32((int64_t)(a) - (int64_t)(b))
+#endif
+
+// Shared state update, returns bandpass (v1) and lowpass (v2)
+static inline void svf_fx_tick(svf_t* f, int32_t v0, int32_t* v1, int32_t* v2){
+  int32_t v3 = svf_subq_s(v0, f->s2);
+  *v1 = svf_extr_rs(svf_madd(svf_mult(f->a1_q31, f->s1), f->a2_q31, v3), 31);
+  *v2 = svf_addq_s(f->s2, svf_extr_rs(svf_madd(svf_mult(f->a2_q31, f->s1), f->a3_q31, v3), 31));
+  f->s1 = svf_subq_s(svf_addq_s(*v1, *v1), f->s1);
+  f->s2 = svf_subq_s(svf_addq_s(*v2, *v2), f->s2);
+}
+
+static inline int32_t svf_fx_process_lp(svf_t* f, int32_t v0){
+  int32_t v1, v2;
+  svf_fx_tick(f, v0, &v1, &v2);
+  return v2;  // Lowpass output
+}
+
+static inline int32_t svf_fx_process_hp(svf_t* f, int32_t v0){
+  int32_t v1, v2;
+  svf_fx_tick(f, v0, &v1, &v2);
+  return svf_subq_s(svf_subq_s(v0, svf_extr_rs(svf_mult(f->k_q29, v1), 29)), v2);  // Highpass output
+}
+
+static inline int32_t svf_fx_process_bp(svf_t* f, int32_t v0){
+  int32_t v1, v2;
+  svf_fx_tick(f, v0, &v1, &v2);
+  return v1;  // Bandpass output
+}
+
+static inline int32_t svf_fx_process_notch(svf_t* f, int32_t v0){
+  int32_t v1, v2;
+  svf_fx_tick(f, v0, &v1, &v2);
+  return svf_subq_s(v0, svf_extr_rs(svf_mult(f->k_q29, v1), 29));  // Notch output (v0 - BP)
+}
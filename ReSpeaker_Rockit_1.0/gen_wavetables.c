@@ -0,0 +1,159 @@
+/**
+ * Band-limited mipmap generator (host tool)
+ *
+ * Writes <out>.c and <out>.h with square, ramp, triangle and parabolic
+ * tables for one output sample rate. Every MIDI note gets the richest table
+ * whose highest harmonic stays below Nyquist at the top of that note's
+ * semitone (plus any pitch-LFO/detune headroom from --guard), so playback
+ * needs no runtime blending between levels. Notes that end up with the same
+ * harmonic count share a level.
+ *
+ * Waveform phase and polarity match the original Rockit tables (falling
+ * ramp, square high for the first half, triangle peaking at a quarter
+ * cycle, parabola peaking mid-cycle). 8-bit tables are unsigned around 128
+ * like wavetables.c; 16-bit tables are signed.
+ *
+ * Usage: gen_wavetables --rate HZ [--len N] [--bits 8|16] [--guard SEMITONES] --out PATH
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MAX_LEN 4096
+
+enum { SH_SQUARE, SH_RAMP, SH_TRI, SH_PARABOLIC, SH_COUNT };
+static const char *SHAPE_NAMES[SH_COUNT] = { "SQUARE", "RAMP", "TRIANGLE", "PARABOLIC" };
+
+// Fourier coefficient of harmonic h on sin(h x) (s) and cos(h x) (c)
+static void coeff(int shape, int h, double *s, double *c){
+    *s = 0.0;
+    *c = 0.0;
+    switch(shape){
+        case SH_SQUARE:    if(h & 1) *s = 1.0 / h; break;
+        case SH_RAMP:      *s = 1.0 / h; break;
+        case SH_TRI:       if(h & 1) *s = ((h & 2) ? -1.0 : 1.0) / ((double)h * h); break;
+        case SH_PARABOLIC: *c = -1.0 / ((double)h * h); break;
+    }
+}
+
+static void synth(double *dst, int len, int shape, int harmonics){
+    for(int i=0; i<len; i++){
+        double x = 2.0 * M_PI * i / len;
+        double v = 0.0;
+        for(int h=1; h<=harmonics; h++){
+            double s, c;
+            coeff(shape, h, &s, &c);
+            if(s != 0.0) v += s * sin(h * x);
+            if(c != 0.0) v += c * cos(h * x);
+        }
+        dst[i] = v;
+    }
+}
+
+static int usage(const char *argv0){
+    fprintf(stderr, "Usage: %s --rate HZ [--len N] [--bits 8|16] [--guard SEMITONES] --out PATH\n", argv0);
+    return 1;
+}
+
+int main(int argc, char **argv){
+    int rate = 0, len = 256, bits = 8;
+    double guard = 0.5;
+    const char *out = NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--rate") == 0 && i+1 < argc) rate = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--len") == 0 && i+1 < argc) len = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--bits") == 0 && i+1 < argc) bits = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--guard") == 0 && i+1 < argc) guard = atof(argv[++i]);
+        else if(strcmp(argv[i], "--out") == 0 && i+1 < argc) out = argv[++i];
+        else return usage(argv[0]);
+    }
+    if(rate <= 0 || !out || (bits != 8 && bits != 16) || len < 8 || len > MAX_LEN || (len & (len - 1))){
+        fprintf(stderr, "gen_wavetables: need --rate > 0, --out, --bits 8|16 and a power-of-two --len (8-%d)\n", MAX_LEN);
+        return usage(argv[0]);
+    }
+
+    // Harmonic count per note: top of the semitone plus the guard, below Nyquist
+    int max_h = len / 2 - 1;
+    int note_h[128];
+    for(int n=0; n<128; n++){
+        double f_top = 440.0 * pow(2.0, (n + 1.0 + guard - 69.0) / 12.0);
+        int h = (int)floor((rate * 0.5) / f_top);
+        if(h > max_h) h = max_h;
+        if(h < 1) h = 1;
+        note_h[n] = h;
+    }
+
+    // One level per distinct harmonic count (non-increasing with note)
+    int level_h[128], levels = 0;
+    int note_level[128];
+    for(int n=0; n<128; n++){
+        if(levels == 0 || level_h[levels-1] != note_h[n]) level_h[levels++] = note_h[n];
+        note_level[n] = levels - 1;
+    }
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s.h", out);
+    FILE *fh = fopen(path, "w");
+    if(!fh){ perror(path); return 1; }
+    snprintf(path, sizeof(path), "%s.c", out);
+    FILE *fc = fopen(path, "w");
+    if(!fc){ perror(path); fclose(fh); return 1; }
+
+    const char *type = (bits == 8) ? "uint8_t" : "int16_t";
+    const char *base = strrchr(out, '/') ? strrchr(out, '/') + 1 : out;
+
+    fprintf(fh, "// Generated by gen_wavetables --rate %d --len %d --bits %d --guard %.2f - do not edit\n",
+            rate, len, bits, guard);
+    fprintf(fh, "#pragma once\n#include <stdint.h>\n\n");
+    fprintf(fh, "#define BL_RATE %d\n#define BL_LEN %d\n#define BL_BITS %d\n#define BL_LEVELS %d\n\n",
+            rate, len, bits, levels);
+    fprintf(fh, "extern const uint8_t BL_NOTE_LEVEL[128];\n");
+    fprintf(fh, "extern const uint16_t BL_LEVEL_HARMONICS[BL_LEVELS];\n");
+    for(int s=0; s<SH_COUNT; s++)
+        fprintf(fh, "extern const %s BL_%s[BL_LEVELS][BL_LEN];\n", type, SHAPE_NAMES[s]);
+
+    fprintf(fc, "// Generated by gen_wavetables --rate %d --len %d --bits %d --guard %.2f - do not edit\n",
+            rate, len, bits, guard);
+    fprintf(fc, "#include \"%s.h\"\n\n", base);
+
+    fprintf(fc, "const uint8_t BL_NOTE_LEVEL[128] = {");
+    for(int n=0; n<128; n++) fprintf(fc, "%s%d,", (n % 16) ? " " : "\n    ", note_level[n]);
+    fprintf(fc, "\n};\n\n");
+
+    fprintf(fc, "const uint16_t BL_LEVEL_HARMONICS[BL_LEVELS] = {");
+    for(int l=0; l<levels; l++) fprintf(fc, "%s%d,", (l % 16) ? " " : "\n    ", level_h[l]);
+    fprintf(fc, "\n};\n");
+
+    static double buf[MAX_LEN];
+    for(int s=0; s<SH_COUNT; s++){
+        // One scale per shape from the peak over all levels, so the level
+        // change between notes never changes loudness or clips
+        double peak = 1e-9;
+        for(int l=0; l<levels; l++){
+            synth(buf, len, s, level_h[l]);
+            for(int i=0; i<len; i++) if(fabs(buf[i]) > peak) peak = fabs(buf[i]);
+        }
+
+        fprintf(fc, "\nconst %s BL_%s[BL_LEVELS][BL_LEN] = {\n", type, SHAPE_NAMES[s]);
+        for(int l=0; l<levels; l++){
+            synth(buf, len, s, level_h[l]);
+            fprintf(fc, "    { // level %d: %d harmonics", l, level_h[l]);
+            for(int i=0; i<len; i++){
+                long v;
+                if(bits == 8) v = 128 + lround(buf[i] / peak * 127.0);
+                else v = lround(buf[i] / peak * 32767.0);
+                fprintf(fc, "%s%ld,", (i % 16) ? " " : "\n      ", v);
+            }
+            fprintf(fc, "\n    },\n");
+        }
+        fprintf(fc, "};\n");
+    }
+
+    fclose(fc);
+    fclose(fh);
+    fprintf(stderr, "gen_wavetables: %s.{c,h}: %d Hz, %d levels x %d x %d-bit\n", out, rate, levels, len, bits);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include "wavetables.h"
+
+// LFO state: 32-bit phase, 16 shapes (the oscillator set) from the 8-bit
+// tables, advanced by the engine once per control block
+typedef struct{
+    uint32_t ph, inc;
+    uint8_t shape;
+    int16_t depth_q;
+    uint16_t lfsr;          // Noise shape
+} lfo_t;
+
+static inline int16_t lut8_to_q15(uint8_t s){
+    return ((int16_t)s-128)<<7;
+}
+
+// LFO waveform generation - 16 shapes
+static inline int16_t lfo_wave(lfo_t *l){
+    uint8_t i=(uint8_t)(l->ph>>24);
+    
+    switch(l->shape){
+        case 0:  // Sine
+            return lut8_to_q15(G_AUC_SIN_LUT[i]);
+        case 1:  // Square
+            return (i<128)?32767:-32768;
+        case 2:  // Ramp/Saw
+            return lut8_to_q15(i);
+        case 3:  // Triangle
+            return lut8_to_q15((i<128)?(i<<1):(255-((i-128)<<1)));
+        case 4:
+        case 5:
+        case 6:
+            return lut8_to_q15(G_AUC_TRIANGLE_SIMPLE_WAVETABLE_LUT[i]);
+        case 7:
+        case 8:
+        case 9:
+            return lut8_to_q15(G_AUC_SQUARE_SIMPLE_WAVETABLE_LUT[i]);
+        case 10: // Reverse ramp
+            return lut8_to_q15(255-i);
+        case 11:
+        case 12:
+            return lut8_to_q15(G_AUC_RAMP_SIMPLE_WAVETABLE_LUT[i]);
+        case 13: // Hard sync
+            return lut8_to_q15(G_AUC_HARDSYNC_2_SIMPLE_WAVETABLE_LUT[i>>1]);
+        case 14: // Noise (LFSR)
+            if((i & 0x0F) == 0) {
+                uint16_t bit = ((l->lfsr >> 15) ^ (l->lfsr >> 13) ^ (l->lfsr >> 12) ^ (l->lfsr >> 10)) & 1;
+                l->lfsr = (l->lfsr << 1) | bit;
+            }
+            return (int16_t)(l->lfsr & 0xFFFF) - 16384;
+        case 15: // Raw square
+            return (i<128)?32767:-32768;
+        default:
+            return lut8_to_q15(G_AUC_SIN_LUT[i]);
+    }
+}
+
+// Bipolar LFO output scaled by depth: -127..+127 parameter units at full depth
+static inline int16_t lfo_mod(lfo_t *l, int depth){
+    if(depth <= 0) return 0;
+    uint8_t w = (uint8_t)((lfo_wave(l) + 32768) >> 8);
+    return (int16_t)((((int16_t)w - 128) * depth) >> 7);
+}
@@ -5,13 +5,33 @@
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
-#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include "rockit_engine.h"
+#include "audio_fifo.h"
 #include "socket_midi_raw.h"
+#include "midi_uart_raw.h"
 #include "patch_storage.h"
 
 static volatile int run=1; 
 static snd_pcm_t* h=NULL;
+static int use_mmap=0;      // Access mode setup() got: mmap (render into the ring) or RW
+
+// Output statistics (STATS command); written by the audio threads
+static uint32_t xruns;              // ALSA underruns recovered
+static uint32_t fifo_underruns;     // Pipelined: periods with nothing rendered (silence played)
+static uint32_t fifo_min_fill;      // Pipelined: lowest FIFO fill since the last STATS
+
+// Recover from a PCM error, counting underruns
+static int pcm_recover(int err){
+    if(err == -EPIPE) __atomic_fetch_add(&xruns, 1, __ATOMIC_RELAXED);
+    return snd_pcm_recover(h, err, 1);
+}
 
 static void onint(int s){
     (void)s;
@@ -19,7 +39,9 @@ static void onint(int s){
 }
 
 // FIX: Replaced *_alloca with *_malloc/*_free functions to fix linker error.
-static int setup(const char*d, int r, snd_pcm_uframes_t p){
+// try_mmap: ask for mmap access first, falling back to RW if the device refuses.
+// *r is the requested rate on entry and the rate the device runs at on return.
+static int setup(const char*d, int *r, snd_pcm_uframes_t p, int try_mmap){
     int e; 
     snd_pcm_hw_params_t *hw = NULL; 
     snd_pcm_sw_params_t *sw = NULL;
@@ -37,9 +59,16 @@ static int setup(const char*d, int r, snd_pcm_uframes_t p){
     }
 
     snd_pcm_hw_params_any(h,hw);
-    snd_pcm_hw_params_set_access(h,hw,SND_PCM_ACCESS_RW_INTERLEAVED);
+    use_mmap = try_mmap && snd_pcm_hw_params_set_access(h,hw,SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+    if(!use_mmap && (e=snd_pcm_hw_params_set_access(h,hw,SND_PCM_ACCESS_RW_INTERLEAVED))<0){
+        fprintf(stderr,"access: %s\n",snd_strerror(e));
+        snd_pcm_hw_params_free(hw);
+        snd_pcm_close(h);
+        return -1;
+    }
     snd_pcm_hw_params_set_format(h,hw,SND_PCM_FORMAT_S16_LE);
-    snd_pcm_hw_params_set_rate(h,hw,r,0);
+    unsigned int rr = (unsigned int)*r;
+    snd_pcm_hw_params_set_rate_near(h,hw,&rr,0);
     snd_pcm_hw_params_set_channels(h,hw,2);
     
     snd_pcm_uframes_t bs=p*4;
@@ -52,6 +81,7 @@ static int setup(const char*d, int r, snd_pcm_uframes_t p){
         snd_pcm_close(h);
         return -1;
     }
+    if(snd_pcm_hw_params_get_rate(hw,&rr,0) == 0) *r = (int)rr;
     
     // Allocate software parameters structure
     if (snd_pcm_sw_params_malloc(&sw) < 0) {
@@ -80,120 +110,377 @@ static int setup(const char*d, int r, snd_pcm_uframes_t p){
     return 0;
 }
 
+// The synth; rendered by the main loop below
+static rockit_engine_t engine;
+
+// mmap access: render one period straight into the DMA ring instead of into
+// a buffer that snd_pcm_writei() copies. A period that wraps the end of the
+// ring is rendered once into buf and copied in two parts: two render calls
+// would each map the period's MIDI events onto their own part.
+// Returns -1 on an unrecoverable error.
+static int write_period_mmap(int16_t *buf, snd_pcm_uframes_t per, int rate){
+    // Wait for a period of free space
+    for(;;){
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(h);
+        if(avail < 0){
+            if(pcm_recover((int)avail) < 0) return -1;
+            continue;
+        }
+        if((snd_pcm_uframes_t)avail >= per) break;
+        int e = snd_pcm_wait(h, 1000);
+        if(e < 0 && pcm_recover(e) < 0) return -1;
+    }
+
+    snd_pcm_uframes_t left = per;
+    int in_buf = 0;     // The period is rendered into buf
+    while(left > 0){
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t off, frames = left;
+        int e = snd_pcm_mmap_begin(h, &areas, &off, &frames);
+        if(e < 0) return pcm_recover(e) < 0 ? -1 : 0;
+
+        if(!in_buf && frames == per && areas[0].step == 32 && areas[0].first == 0 &&
+           areas[1].addr == areas[0].addr && areas[1].step == 32 && areas[1].first == 16){
+            // Whole period, interleaved S16 stereo: the engine's own output layout
+            int16_t *dst = (int16_t*)((uint8_t*)areas[0].addr + off * 4);
+            rockit_engine_render(&engine, dst, frames, rate);
+        } else {
+            // Wraps the ring end, or an unexpected layout (plugin in
+            // between): render the whole period once and copy it out
+            snd_pcm_channel_area_t src[2] = {
+                { buf, 0, 32 }, { buf, 16, 32 },
+            };
+            if(!in_buf){
+                rockit_engine_render(&engine, buf, per, rate);
+                in_buf = 1;
+            }
+            snd_pcm_areas_copy(areas, off, src, per - left, 2, frames, SND_PCM_FORMAT_S16_LE);
+        }
+
+        snd_pcm_sframes_t c = snd_pcm_mmap_commit(h, off, frames);
+        if(c < 0 || (snd_pcm_uframes_t)c != frames)
+            return pcm_recover(c < 0 ? (int)c : -EPIPE) < 0 ? -1 : 0;
+        left -= frames;
+    }
+
+    // Committing does not start the stream the way a write does (start
+    // threshold is one period)
+    if(snd_pcm_state(h) == SND_PCM_STATE_PREPARED){
+        int e = snd_pcm_start(h);
+        if(e < 0 && pcm_recover(e) < 0) return -1;
+    }
+    return 0;
+}
+
+// Real-time mode (--realtime): the audio threads run SCHED_FIFO, all memory
+// is locked with mlockall() and the buffers and stacks of the audio path are
+// faulted in before the first period, so it never waits on the pager
+static int realtime = 0;
+#define WRITER_PRIORITY 70          // SCHED_FIFO: the thread that feeds ALSA
+#define RENDER_PRIORITY 65          // Pipelined renderer, below its writer
+#define THREAD_STACK (256 * 1024)   // Our threads' stacks: locked in full under --realtime
+#define PREFAULT_STACK (64 * 1024)  // Stack touched on each audio thread
+
+// What --realtime was granted: 0, or the errno (-1 = not attempted)
+static int rt_sched_err = -1, rt_render_sched_err = -1, rt_mlock_err = -1;
+static size_t rt_prefaulted;        // Buffer bytes touched
+
+// Lock current and future pages, and keep malloc from trimming the heap or
+// serving blocks from fresh mmaps (both would bring page faults back)
+static void realtime_lock(void){
+#ifdef M_TRIM_THRESHOLD
+    mallopt(M_TRIM_THRESHOLD, -1);
+#endif
+#ifdef M_MMAP_MAX
+    mallopt(M_MMAP_MAX, 0);
+#endif
+    rt_mlock_err = mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? 0 : errno;
+}
+
+// Write every page of a buffer so it is backed (copy-on-write zero pages
+// too). Adding zero atomically keeps this safe on memory that other threads
+// (the MIDI receivers, the renderer) are already using.
+static void prefault(void *p, size_t n){
+    uint8_t *b = (uint8_t *)p;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for(size_t i=0; i<n; i+=page) __atomic_fetch_add(&b[i], 0, __ATOMIC_RELAXED);
+    if(n) __atomic_fetch_add(&b[n-1], 0, __ATOMIC_RELAXED);
+    rt_prefaulted += n;
+}
+
+// Grow the calling thread's stack by PREFAULT_STACK now rather than mid-period
+static void __attribute__((noinline)) prefault_stack(void){
+    volatile uint8_t stack[PREFAULT_STACK];
+    for(size_t i=0; i<sizeof(stack); i+=256) stack[i] = 0;
+}
+
+static int set_fifo(pthread_t t, int prio){
+    struct sched_param sp = { .sched_priority = prio };
+    return pthread_setschedparam(t, SCHED_FIFO, &sp);
+}
+
+// Threads get THREAD_STACK: the libc default (often 8 MB) would all be locked
+static int start_thread(pthread_t *t, void *(*fn)(void *), void *arg){
+    pthread_attr_t a;
+    pthread_attr_init(&a);
+    pthread_attr_setstacksize(&a, THREAD_STACK);
+    int r = pthread_create(t, &a, fn, arg);
+    pthread_attr_destroy(&a);
+    return r;
+}
+
+// Pipelined output (--pipeline N): a render thread keeps the FIFO up to N
+// periods ahead and the writer (the main thread, SCHED_FIFO if permitted)
+// only moves rendered periods into ALSA, so a slow render call uses up
+// FIFO margin instead of causing an xrun
+static int pipeline = 0;            // FIFO depth in periods, 0 = render and write on one thread
+static audio_fifo_t fifo;
+static sem_t fifo_space;            // Free FIFO periods: posted by the writer, taken by the renderer
+
+static void *render_thread(void *arg){
+    int rate = *(const int *)arg;
+    if(realtime) prefault_stack();
+    while(run){
+        if(sem_wait(&fifo_space) < 0) continue;     // EINTR
+        int16_t *slot = audio_fifo_write_slot(&fifo);
+        if(!slot) continue;                         // Woken for shutdown
+        rockit_engine_render(&engine, slot, fifo.period, rate);
+        audio_fifo_commit(&fifo);
+    }
+    return NULL;
+}
+
+// Writer side: play the oldest rendered period, or silence if the renderer
+// fell behind. Returns -1 on an unrecoverable error.
+static int write_period_fifo(const int16_t *silence){
+    uint32_t fill = audio_fifo_fill(&fifo);
+    if(fill < __atomic_load_n(&fifo_min_fill, __ATOMIC_RELAXED))
+        __atomic_store_n(&fifo_min_fill, fill, __ATOMIC_RELAXED);
+
+    const int16_t *p = audio_fifo_read_slot(&fifo);
+    if(!p){
+        __atomic_fetch_add(&fifo_underruns, 1, __ATOMIC_RELAXED);
+        p = silence;
+    }
+
+    const int16_t *src = p;
+    snd_pcm_uframes_t left = fifo.period;
+    while(left > 0){
+        snd_pcm_sframes_t w = snd_pcm_writei(h, src, left);
+        if(w < 0){
+            if(pcm_recover((int)w) < 0) return -1;
+            continue;
+        }
+        src += w * 2;
+        left -= w;
+    }
+
+    if(p != silence){
+        audio_fifo_release(&fifo);
+        sem_post(&fifo_space);
+    }
+    return 0;
+}
+
+// Socket MIDI runs on its own thread: it only pushes into this queue and
+// the audio thread applies the events at their sample offsets
+static midi_queue_t socket_q;
+
+static void socket_push(uint8_t status, uint8_t d1, uint8_t d2){
+    if(midi_queue_push(&socket_q, status, d1, d2) < 0)
+        fprintf(stderr, "Warning: MIDI queue full, dropped %02X %d %d\n", status, d1, d2);
+}
+
 static void cc_handler(uint8_t cc, uint8_t val){
-    rockit_handle_cc(cc, val);
+    // Patch save/recall does file I/O: handle it here, off the audio thread
+    if(rockit_handle_patch_cc(&engine, cc, val)) return;
+    socket_push(0xB0, cc, val);
 }
 
 static void note_on_cb(uint8_t note){ 
-    rockit_note_on(note); 
+    socket_push(0x90, note, 100);
 }
 
 static void note_off_cb(uint8_t note){ 
-    rockit_note_off(note); 
+    socket_push(0x80, note, 0);
+}
+
+// A MIDI keyboard on the UART (--uart DEV) has its own reader thread and
+// so its own queue: each queue has exactly one producer
+static midi_queue_t uart_q;
+
+static void uart_push(uint8_t status, uint8_t d1, uint8_t d2){
+    if(midi_queue_push(&uart_q, status, d1, d2) < 0)
+        fprintf(stderr, "Warning: UART MIDI queue full, dropped %02X %d %d\n", status, d1, d2);
+}
+
+static void uart_cc_cb(uint8_t cc, uint8_t val){
+    if(rockit_handle_patch_cc(&engine, cc, val)) return;
+    uart_push(0xB0, cc, val);
+}
+
+static void uart_note_on_cb(uint8_t note){
+    uart_push(0x90, note, 100);
+}
+
+static void uart_note_off_cb(uint8_t note){
+    uart_push(0x80, note, 0);
+}
+
+// The CLI runs on its own thread too, blocking on stdin, and reaches the
+// engine through its own queue: the audio thread does no stdin syscalls
+static midi_queue_t cli_q;
+
+static void cli_push(uint8_t status, uint8_t d1, uint8_t d2){
+    if(midi_queue_push(&cli_q, status, d1, d2) < 0)
+        fprintf(stderr, "Warning: CLI queue full, dropped %02X %d %d\n", status, d1, d2);
 }
 
 // Track which notes are currently held via CLI
 static uint8_t cli_notes_held[128] = {0};
 
 // --- IMPROVED CLI Handler with note holding ---
-static void handle_cli_input() {
-    char input_line[64];
+static void handle_cli_line(const char *input_line) {
     char command[16];
-    int value;
+    int value = 0;
 
-    // Make stdin non-blocking
-    int flags = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
-    
-    if (fgets(input_line, sizeof(input_line), stdin) != NULL) {
-        // Restore blocking mode
-        fcntl(STDIN_FILENO, F_SETFL, flags);
-        
-        if (sscanf(input_line, "%15s %d", command, &value) >= 1) {
-            
-            // Convert command to uppercase
-            for (int i = 0; command[i]; i++) {
-                command[i] = toupper(command[i]);
-            }
+    if (sscanf(input_line, "%15s %d", command, &value) >= 1) {
 
-            // Clamp MIDI values to 0-127
-            if (value < 0) value = 0;
-            if (value > 127) value = 127;
-
-            // Handle commands
-            if (strcmp(command, "CUTOFF") == 0 || strcmp(command, "FLT") == 0) {
-                rockit_handle_cc(74, (uint8_t)value);
-                fprintf(stderr, "CLI: Set Cutoff to %d\n", value);
-            } else if (strcmp(command, "RESO") == 0 || strcmp(command, "Q") == 0) {
-                rockit_handle_cc(71, (uint8_t)value);
-                fprintf(stderr, "CLI: Set Resonance to %d\n", value);
-            } else if (strcmp(command, "VOL") == 0 || strcmp(command, "VOLUME") == 0) {
-                rockit_handle_cc(7, (uint8_t)value);
-                fprintf(stderr, "CLI: Set Volume to %d\n", value);
-            } else if (strcmp(command, "MIX") == 0) {
-                rockit_handle_cc(72, (uint8_t)value);
-                fprintf(stderr, "CLI: Set OSC Mix to %d\n", value);
-            } else if (strcmp(command, "ATTACK") == 0 || strcmp(command, "ATK") == 0) {
-                rockit_handle_cc(73, (uint8_t)value);
-                fprintf(stderr, "CLI: Set Attack to %d\n", value);
-            } else if (strcmp(command, "DECAY") == 0 || strcmp(command, "DEC") == 0) {
-                rockit_handle_cc(75, (uint8_t)value);
-                fprintf(stderr, "CLI: Set Decay to %d\n", value);
-            } else if (strcmp(command, "RELEASE") == 0 || strcmp(command, "REL") == 0) {
-                rockit_handle_cc(70, (uint8_t)value);
-                fprintf(stderr, "CLI: Set Release to %d\n", value);
-            } else if (strcmp(command, "NOTE") == 0 || strcmp(command, "ON") == 0 || strcmp(command, "N") == 0) {
-                // Turn on note and track it
-                rockit_note_on((uint8_t)value);
-                cli_notes_held[value] = 1;
-                fprintf(stderr, "CLI: Note On %d (stays on until OFF)\n", value);
-            } else if (strcmp(command, "OFF") == 0) {
-                // Turn off specific note
-                rockit_note_off((uint8_t)value);
-                cli_notes_held[value] = 0;
-                fprintf(stderr, "CLI: Note Off %d\n", value);
-            } else if (strcmp(command, "ALLOFF") == 0 || strcmp(command, "PANIC") == 0) {
-                // Turn off all notes
-                for(int i = 0; i < 128; i++) {
-                    if(cli_notes_held[i]) {
-                        rockit_note_off(i);
-                        cli_notes_held[i] = 0;
-                    }
-                }
-                fprintf(stderr, "CLI: All notes off\n");
-            } else if (strcmp(command, "HELP") == 0 || strcmp(command, "?") == 0) {
-                fprintf(stderr, "\nCLI Commands:\n");
-                fprintf(stderr, "  NOTE <0-127>      - Turn note on (stays on!)\n");
-                fprintf(stderr, "  OFF <0-127>       - Turn note off\n");
-                fprintf(stderr, "  ALLOFF            - Turn all notes off\n");
-                fprintf(stderr, "  CUTOFF <0-127>    - Filter cutoff\n");
-                fprintf(stderr, "  RESO <0-127>      - Filter resonance\n");
-                fprintf(stderr, "  VOL <0-127>       - Master volume\n");
-                fprintf(stderr, "  MIX <0-127>       - Oscillator mix\n");
-                fprintf(stderr, "  ATTACK <0-127>    - Envelope attack\n");
-                fprintf(stderr, "  DECAY <0-127>     - Envelope decay\n");
-                fprintf(stderr, "  RELEASE <0-127>   - Envelope release\n");
-                fprintf(stderr, "  HELP              - Show this help\n\n");
-            } else {
-                fprintf(stderr, "CLI: Unknown command '%s' (type HELP)\n", command);
+        // Convert command to uppercase
+        for (int i = 0; command[i]; i++) {
+            command[i] = toupper(command[i]);
+        }
+
+        // Clamp MIDI values to 0-127
+        if (value < 0) value = 0;
+        if (value > 127) value = 127;
+
+        // Handle commands
+        if (strcmp(command, "CUTOFF") == 0 || strcmp(command, "FLT") == 0) {
+            cli_push(0xB0, 74, (uint8_t)value);
+            fprintf(stderr, "CLI: Set Cutoff to %d\n", value);
+        } else if (strcmp(command, "RESO") == 0 || strcmp(command, "Q") == 0) {
+            cli_push(0xB0, 71, (uint8_t)value);
+            fprintf(stderr, "CLI: Set Resonance to %d\n", value);
+        } else if (strcmp(command, "VOL") == 0 || strcmp(command, "VOLUME") == 0) {
+            cli_push(0xB0, 7, (uint8_t)value);
+            fprintf(stderr, "CLI: Set Volume to %d\n", value);
+        } else if (strcmp(command, "MIX") == 0) {
+            cli_push(0xB0, 72, (uint8_t)value);
+            fprintf(stderr, "CLI: Set OSC Mix to %d\n", value);
+        } else if (strcmp(command, "ATTACK") == 0 || strcmp(command, "ATK") == 0) {
+            cli_push(0xB0, 73, (uint8_t)value);
+            fprintf(stderr, "CLI: Set Attack to %d\n", value);
+        } else if (strcmp(command, "DECAY") == 0 || strcmp(command, "DEC") == 0) {
+            cli_push(0xB0, 75, (uint8_t)value);
+            fprintf(stderr, "CLI: Set Decay to %d\n", value);
+        } else if (strcmp(command, "RELEASE") == 0 || strcmp(command, "REL") == 0) {
+            cli_push(0xB0, 70, (uint8_t)value);
+            fprintf(stderr, "CLI: Set Release to %d\n", value);
+        } else if (strcmp(command, "NOTE") == 0 || strcmp(command, "ON") == 0 || strcmp(command, "N") == 0) {
+            // Turn on note and track it
+            cli_push(0x90, (uint8_t)value, 100);
+            cli_notes_held[value] = 1;
+            fprintf(stderr, "CLI: Note On %d (stays on until OFF)\n", value);
+        } else if (strcmp(command, "OFF") == 0) {
+            // Turn off specific note
+            cli_push(0x80, (uint8_t)value, 0);
+            cli_notes_held[value] = 0;
+            fprintf(stderr, "CLI: Note Off %d\n", value);
+        } else if (strcmp(command, "ALLOFF") == 0 || strcmp(command, "PANIC") == 0) {
+            // All Notes Off releases every voice, whoever played it; PANIC
+            // sends All Sound Off and cuts them instead
+            int cut = strcmp(command, "PANIC") == 0;
+            cli_push(0xB0, cut ? 120 : 123, 0);
+            memset(cli_notes_held, 0, sizeof(cli_notes_held));
+            fprintf(stderr, "CLI: %s\n", cut ? "All sound off" : "All notes off");
+        } else if (strcmp(command, "STATS") == 0) {
+            fprintf(stderr, "Output: %s, %u xruns\n",
+                    pipeline ? "pipelined" : (use_mmap ? "mmap" : "RW"),
+                    __atomic_load_n(&xruns, __ATOMIC_RELAXED));
+            if (pipeline) {
+                // The minimum restarts from full for the next STATS
+                fprintf(stderr, "FIFO: %u/%d periods, min %u since last STATS, %u underruns\n",
+                        audio_fifo_fill(&fifo), pipeline,
+                        __atomic_exchange_n(&fifo_min_fill, (uint32_t)pipeline, __ATOMIC_RELAXED),
+                        __atomic_load_n(&fifo_underruns, __ATOMIC_RELAXED));
             }
+        } else if (strcmp(command, "HELP") == 0 || strcmp(command, "?") == 0) {
+            fprintf(stderr, "\nCLI Commands:\n");
+            fprintf(stderr, "  NOTE <0-127>      - Turn note on (stays on!)\n");
+            fprintf(stderr, "  OFF <0-127>       - Turn note off\n");
+            fprintf(stderr, "  ALLOFF            - Release all notes (CC 123)\n");
+            fprintf(stderr, "  PANIC             - Silence all notes at once (CC 120)\n");
+            fprintf(stderr, "  CUTOFF <0-127>    - Filter cutoff\n");
+            fprintf(stderr, "  RESO <0-127>      - Filter resonance\n");
+            fprintf(stderr, "  VOL <0-127>       - Master volume\n");
+            fprintf(stderr, "  MIX <0-127>       - Oscillator mix\n");
+            fprintf(stderr, "  ATTACK <0-127>    - Envelope attack\n");
+            fprintf(stderr, "  DECAY <0-127>     - Envelope decay\n");
+            fprintf(stderr, "  RELEASE <0-127>   - Envelope release\n");
+            fprintf(stderr, "  STATS             - Xruns and FIFO fill level\n");
+            fprintf(stderr, "  HELP              - Show this help\n\n");
+        } else {
+            fprintf(stderr, "CLI: Unknown command '%s' (type HELP)\n", command);
         }
-    } else {
-        // Restore blocking mode even if no input
-        fcntl(STDIN_FILENO, F_SETFL, flags);
     }
 }
+
+static void *cli_thread(void *arg){
+    (void)arg;
+    char input_line[64];
+    while (run && fgets(input_line, sizeof(input_line), stdin) != NULL) {
+        handle_cli_line(input_line);
+    }
+    return NULL;
+}
 // --- END IMPROVED CLI ---
 
+static void report_grant(const char *what, int err){
+    if(err == 0) fprintf(stderr, "  %-26s granted\n", what);
+    else if(err > 0) fprintf(stderr, "  %-26s DENIED (%s)\n", what, strerror(err));
+}
+
+static void realtime_report(void){
+    char what[48];
+    fprintf(stderr, "Realtime:\n");
+    snprintf(what, sizeof(what), "SCHED_FIFO %d %s", WRITER_PRIORITY, pipeline ? "writer" : "audio thread");
+    report_grant(what, rt_sched_err);
+    snprintf(what, sizeof(what), "SCHED_FIFO %d renderer", RENDER_PRIORITY);
+    report_grant(what, rt_render_sched_err);
+    report_grant("mlockall (current+future)", rt_mlock_err);
+    fprintf(stderr, "  Pre-faulted %zu KB of buffers, %d KB of stack per audio thread\n",
+            rt_prefaulted / 1024, PREFAULT_STACK / 1024);
+
+    struct rlimit rl;
+#ifdef RLIMIT_RTPRIO
+    if((rt_sched_err > 0 || rt_render_sched_err > 0) && getrlimit(RLIMIT_RTPRIO, &rl) == 0)
+        fprintf(stderr, "  RLIMIT_RTPRIO is %ld: run as root or raise it (ulimit -r)\n", (long)rl.rlim_cur);
+#endif
+    if(rt_mlock_err > 0 && getrlimit(RLIMIT_MEMLOCK, &rl) == 0){
+        if(rl.rlim_cur == RLIM_INFINITY) fprintf(stderr, "  RLIMIT_MEMLOCK is unlimited\n");
+        else fprintf(stderr, "  RLIMIT_MEMLOCK is %lu KB: run as root or raise it (ulimit -l)\n",
+                     (unsigned long)(rl.rlim_cur / 1024));
+    }
+    fprintf(stderr, "\n");
+}
+
 int main(int argc,char**argv){
     const char*dev = "default"; // Default audio device name
     int rate = 48000;
     snd_pcm_uframes_t per = 256;
+    int try_mmap = 1;
+    const char *uart_dev = NULL;
 
     signal(SIGINT, onint);
 
-    rockit_engine_t e;
-    rockit_engine_init(&e);
+    rockit_engine_init(&engine);
+    midi_queue_init(&socket_q);
+    rockit_engine_attach_queue(&engine, &socket_q);
+    midi_queue_init(&cli_q);
+    rockit_engine_attach_queue(&engine, &cli_q);
+    midi_queue_init(&uart_q);
+    rockit_engine_attach_queue(&engine, &uart_q);
 
     // Initialize patch storage system (creates /tmp/rockit_patches directory)
     patch_storage_init();
@@ -207,12 +494,15 @@ int main(int argc,char**argv){
             
             // --- CC COMMANDS ---
             fprintf(stderr,"RAW MIDI TUNNEL (127.0.0.1:50000) Active.\\n");
-            fprintf(stderr,"  Input is 3-byte Raw MIDI (Status, Data1, Data2).\\n");
+            fprintf(stderr,"  Input is a raw MIDI byte stream (running status OK); clients may stay connected.\\n");
+            fprintf(stderr,"  Datagrams of packed messages: UDP 127.0.0.1:50000 or %s.\\n", SOCKET_MIDI_UNIX_PATH);
             fprintf(stderr,"  CC 102: Mono/Para (0-63=Mono, 64-127=Para)\\n");
             fprintf(stderr,"  CC 103: 3-voice (0-63=2-voice, 64-127=3-voice)\\n");
             fprintf(stderr,"  CC 104: Cycle para modes (Low→Last→RR→High)\\n");
             fprintf(stderr,"  CC 105: 3-voice toggle\\n");
             fprintf(stderr,"  CC 76:  Sub-osc (0-63=Off, 64-127=On)\\n");
+            fprintf(stderr,"  CC 83:  Osc engine (0-42=Classic, 43-85=HQ, 86-127=PolyBLEP)\\n");
+            fprintf(stderr,"  CC 77:  Pulse width (64=square)\\n");
             fprintf(stderr,"  CC 1:   LFO Depth\\n");
             fprintf(stderr,"  CC 7:   Master Volume\\n");
             fprintf(stderr,"  CC 74:  Filter Cutoff\\n");
@@ -229,6 +519,44 @@ int main(int argc,char**argv){
             ai++; // Consume the next argument (the device name)
         }
         
+        // MIDI keyboard on a serial port (e.g. /dev/ttyS1), straight to the engine
+        else if(strcmp(argv[ai], "--uart")==0 && ai+1 < argc){
+            uart_dev = argv[++ai];
+        }
+        else if(strcmp(argv[ai], "--uart-baud")==0 && ai+1 < argc){
+            midi_uart_raw_set_baud((unsigned)strtoul(argv[++ai], NULL, 10));
+        }
+
+        // Force RW access (snd_pcm_writei) even if the device supports mmap
+        else if(strcmp(argv[ai], "--rw")==0){
+            try_mmap = 0;
+        }
+
+        // SCHED_FIFO audio threads, locked and pre-faulted memory
+        else if(strcmp(argv[ai], "--realtime")==0){
+            realtime = 1;
+        }
+
+        // Pipelined output: render up to N periods ahead on a separate thread
+        else if(strcmp(argv[ai], "--pipeline")==0 && ai+1 < argc){
+            pipeline = atoi(argv[ai+1]);
+            ai++;
+            if(pipeline < 1 || pipeline > 64){
+                fprintf(stderr, "Pipeline depth must be 1-64 periods\n");
+                return 1;
+            }
+        }
+
+        // Period size in frames (smaller = lower latency, more wakeups)
+        else if(strcmp(argv[ai], "-p")==0 && ai+1 < argc){
+            per = strtoul(argv[ai+1], NULL, 10);
+            ai++;
+            if(per < 16 || per > 4096){
+                fprintf(stderr, "Period must be 16-4096 frames\n");
+                return 1;
+            }
+        }
+
         // 3. Otherwise, if the current device is still 'default', set it to this argument
         else if (strcmp(dev, "default") == 0) {
             dev = argv[ai];
@@ -236,10 +564,22 @@ int main(int argc,char**argv){
     }
     // --- END ARGUMENT PARSING LOOP ---
     
+    if(uart_dev && midi_uart_raw_start(uart_dev, uart_note_on_cb, uart_note_off_cb, uart_cc_cb) < 0)
+        fprintf(stderr, "Warning: UART MIDI input on %s not available\n", uart_dev);
+
+    // Before ALSA and the buffers are allocated: MCL_FUTURE locks those as they come
+    if(realtime) realtime_lock();
+
     // Setup audio PCM with the determined device name
-    if(setup(dev, rate, per) < 0) return 1;
+    // Pipelined output copies periods out of the FIFO: RW access
+    if(setup(dev, &rate, per, try_mmap && !pipeline) < 0) return 1;
+    if(osc_table_rate() && rate != osc_table_rate())
+        fprintf(stderr, "Warning: oscillator tables were generated for %d Hz, output is %d Hz (rebuild with BL_RATE=%d)\n",
+                osc_table_rate(), rate, rate);
 
     // Allocate and CLEAR audio buffer to prevent garbage noise on startup
+    // (RW access, mmap periods that wrap the ring or go through an
+    // unexpected channel layout, or the pipelined writer's silence)
     int16_t *buf = (int16_t*)calloc(per * 2, sizeof(int16_t));
     if (!buf) {
         fprintf(stderr, "Error: Failed to allocate audio buffer\n");
@@ -249,7 +589,11 @@ int main(int argc,char**argv){
     fprintf(stderr,"==============================================\n");
     fprintf(stderr,"Rockit Paraphonic Synth - ReSpeaker Edition\n");
     fprintf(stderr,"==============================================\n");
-    fprintf(stderr,"Audio: %s @ %d Hz, period %lu\n", dev, rate, (unsigned long)per);
+    fprintf(stderr,"Audio: %s @ %d Hz, period %lu, %s access\n", dev, rate, (unsigned long)per,
+            use_mmap ? "mmap" : "RW");
+    if(pipeline)
+        fprintf(stderr,"Pipelined: render %d periods ahead (+%.1f ms latency)\n",
+                pipeline, pipeline * (double)per * 1000.0 / rate);
     fprintf(stderr,"Tip: use 'hw:0,0' for 1/4\" line out if default doesn't work\n\n");
     
     fprintf(stderr,"Starting audio engine...\n");
@@ -260,17 +604,81 @@ int main(int argc,char**argv){
 
     fprintf(stderr,"Type 'HELP' for commands. Notes stay on until you turn them OFF!\n\n");
 
+    // Blocked in fgets() at shutdown: detached, it simply ends with the process
+    pthread_t cli_th;
+    if(start_thread(&cli_th, cli_thread, NULL) == 0) pthread_detach(cli_th);
+    else fprintf(stderr, "Warning: CLI thread failed to start\n");
+
+    pthread_t render_th;
+    if(pipeline){
+        if(audio_fifo_init(&fifo, (uint32_t)pipeline, (uint32_t)per) < 0 || sem_init(&fifo_space, 0, pipeline) < 0){
+            fprintf(stderr, "Error: Failed to allocate the audio FIFO\n");
+            return 1;
+        }
+        fifo_min_fill = (uint32_t)pipeline;
+        if(realtime) prefault(fifo.buf, (size_t)(fifo.mask + 1) * per * 2 * sizeof(int16_t));
+        // Created before the writer goes SCHED_FIFO: the renderer keeps normal
+        // priority, or runs SCHED_FIFO just below the writer with --realtime
+        if(start_thread(&render_th, render_thread, &rate) != 0){
+            fprintf(stderr, "Error: Failed to start the render thread\n");
+            return 1;
+        }
+        rt_sched_err = set_fifo(pthread_self(), WRITER_PRIORITY);
+        if(realtime) rt_render_sched_err = set_fifo(render_th, RENDER_PRIORITY);
+        else if(rt_sched_err != 0)
+            fprintf(stderr, "Warning: SCHED_FIFO writer not permitted (%s), normal priority\n", strerror(rt_sched_err));
+    } else if(realtime){
+        rt_sched_err = set_fifo(pthread_self(), WRITER_PRIORITY);
+    }
+
+    if(realtime){
+        prefault(buf, per * 2 * sizeof(int16_t));
+        prefault(&engine, sizeof(engine));
+        prefault(&socket_q, sizeof(socket_q));
+        prefault(&cli_q, sizeof(cli_q));
+        prefault(&uart_q, sizeof(uart_q));
+        prefault_stack();
+        realtime_report();
+    }
+
+    if(pipeline){
+        // Start with a full FIFO
+        while(run && audio_fifo_fill(&fifo) < (uint32_t)pipeline)
+            usleep(1000);
+    }
+
     while(run){
-        rockit_engine_render(&e, buf, per, rate);
+        if(pipeline){
+            if(write_period_fifo(buf) < 0){
+                fprintf(stderr, "Audio: output failed\n");
+                break;
+            }
+            continue;
+        }
+
+        if(use_mmap){
+            if(write_period_mmap(buf, per, rate) < 0){
+                fprintf(stderr, "Audio: mmap output failed\n");
+                break;
+            }
+            continue;
+        }
+
+        rockit_engine_render(&engine, buf, per, rate);
 
         snd_pcm_sframes_t w = snd_pcm_writei(h, buf, per);
-        if(w<0) snd_pcm_prepare(h);
-        
-        // Check for CLI input
-        handle_cli_input();
+        if(w<0) pcm_recover((int)w);
+    }
+
+    if(pipeline){
+        run = 0;
+        sem_post(&fifo_space);  // Wake the renderer if it waits for space
+        pthread_join(render_th, NULL);
+        audio_fifo_free(&fifo);
     }
     
     fprintf(stderr,"\nShutting down...\n");
+    if(uart_dev) midi_uart_raw_stop();   // Restores the line settings
 
     // Properly drain and stop ALSA to prevent state issues on next startup
     snd_pcm_drop(h);       // Drop pending frames immediately
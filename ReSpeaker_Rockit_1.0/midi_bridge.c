@@ -4,32 +4,88 @@
  *
  * Listens on HTTP port 8090, forwards MIDI to TCP port 50000
  * Minimal HTTP parsing for maximum performance on embedded MIPS
+ *
+ * The upstream connection to the synth is opened once and kept; if the synth
+ * restarts, the next send reconnects and retries. Each request goes out as a
+ * single send(), including multi-message batches (/midi?hex=...) and /panic.
+ *
+ * HTTP side: a single-threaded, non-blocking epoll loop serving up to
+ * MAX_CLIENTS connections with HTTP/1.1 keep-alive, so a browser reuses one
+ * connection for every knob move. Requests may be split across reads or
+ * pipelined several to a read; each client has its own buffers, so a slow
+ * or stalled client only holds its own slot (until IDLE_TIMEOUT_MS).
+ *
+ * WebSocket: GET /ws upgrades the connection to a binary MIDI channel. Each
+ * binary frame from the browser carries one or more raw MIDI messages
+ * (running status allowed). Every client has its own stream parser: only
+ * complete messages, each with its status byte, go upstream (one write per
+ * frame), so several senders never share running status on the synth's
+ * single connection. Every MIDI message the bridge forwards, from HTTP or
+ * another socket, is pushed to the other WebSocket clients in the same
+ * form, so several open UIs follow each other's knobs. The synth's MIDI port is receive-only, so this
+ * echo of the forwarded stream is the state the bridge can push back.
+ *
+ * Usage: midi_bridge [--port N] [--midi-port N]
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <time.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <errno.h>
 #include <signal.h>
+#include "websocket.h"
+#include "midi_parser.h"
 
 #define HTTP_PORT 8090
 #define MIDI_PORT 50000
 #define MIDI_HOST "127.0.0.1"
 #define BUFFER_SIZE 2048
-
+#define MAX_BATCH 96         // Bytes per /midi?hex= request (32 three-byte messages)
+#define OUT_SIZE 4096        // Queued responses per client
+#define MAX_CLIENTS 16
+#define LISTENER MAX_CLIENTS // epoll tag of the listening socket
+#define LISTEN_BACKLOG 16
+#define IDLE_TIMEOUT_MS 30000 // HTTP only: WebSocket clients stay while the UI is open
+#define WS_MAX_PAYLOAD 1024   // Largest client frame (MIDI bytes per frame)
+
+typedef struct {
+    int fd;                  // -1 = free slot
+    char in[BUFFER_SIZE + 1];
+    size_t in_len;
+    char out[OUT_SIZE];
+    size_t out_len;
+    int close_after;         // Close once out is flushed (Connection: close or an error)
+    int is_ws;               // Upgraded to WebSocket: the input holds frames
+    midi_parser_t parser;    // WebSocket: running status and partial messages across frames
+    long long last_ms;       // Last activity, for the idle timeout
+} client_t;
+
+static client_t clients[MAX_CLIENTS];
+static int http_port = HTTP_PORT;
+static int midi_port = MIDI_PORT;
 static int http_sock = -1;
+static int epoll_fd = -1;
+static int midi_sock = -1;   // Persistent upstream connection (-1 = not connected)
 static volatile int running = 1;
 
 void signal_handler(int sig) {
+    (void)sig;
     running = 0;
 }
 
-// Send 3-byte raw MIDI message (creates new connection each time like Python version)
-int send_midi_message(unsigned char status, unsigned char data1, unsigned char data2) {
+// Open the upstream connection to the synth
+int midi_connect(void) {
     struct sockaddr_in addr;
     int sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock < 0) {
@@ -43,21 +99,130 @@ int send_midi_message(unsigned char status, unsigned char data1, unsigned char d
     setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
     setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 
+    // Small writes go out immediately instead of waiting on Nagle
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
-    addr.sin_port = htons(MIDI_PORT);
+    addr.sin_port = htons(midi_port);
     inet_pton(AF_INET, MIDI_HOST, &addr.sin_addr);
 
     if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         close(sock);
         return -1;
     }
+    return sock;
+}
+
+void midi_disconnect(void) {
+    if (midi_sock >= 0) close(midi_sock);
+    midi_sock = -1;
+}
+
+// The synth never writes back, so a readable upstream socket means it has
+// closed (EOF or reset): a send would still be accepted into the local
+// buffer and then lost
+int midi_peer_gone(void) {
+    struct pollfd pfd = { midi_sock, POLLIN, 0 };
+    return poll(&pfd, 1, 0) > 0;
+}
+
+// Send raw MIDI bytes in one write over the persistent connection,
+// reconnecting and retrying once if the synth went away. A short send is
+// finished on the same socket; once any byte is out, a failure is not
+// retried on a new connection, which would deliver those bytes twice.
+int send_midi_bytes(const unsigned char *buf, size_t len) {
+    size_t sent = 0;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (midi_sock >= 0 && midi_peer_gone()) midi_disconnect();
+        if (midi_sock < 0) {
+            midi_sock = midi_connect();
+            if (midi_sock < 0) return -1;
+        }
+        while (sent < len) {
+            ssize_t n = send(midi_sock, buf + sent, len - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            sent += n;
+        }
+        if (sent == len) return 0;
+        midi_disconnect();
+        if (sent > 0) return -1;
+    }
+    return -1;
+}
+
+void client_close(client_t *c);
+void client_watch(client_t *c);
+int client_flush(client_t *c);
+
+// Queue a server frame on a WebSocket client; returns -1 if it does not fit
+int ws_queue(client_t *c, int opcode, const unsigned char *payload, size_t len) {
+    uint8_t head[WS_HEADER_MAX];
+    size_t n = ws_frame_header(head, opcode, len);
+    if (c->out_len + n + len > sizeof(c->out)) return -1;
+    memcpy(c->out + c->out_len, head, n);
+    memcpy(c->out + c->out_len + n, payload, len);
+    c->out_len += n + len;
+    return 0;
+}
+
+// Push forwarded MIDI to every WebSocket client but its sender. A client
+// too far behind to take the frame misses it rather than stalling the rest.
+void ws_broadcast(const client_t *from, const unsigned char *buf, size_t len) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        client_t *c = &clients[i];
+        if (c->fd < 0 || !c->is_ws || c == from || c->close_after) continue;
+        if (ws_queue(c, WS_BINARY, buf, len) < 0) continue;
+        if (client_flush(c) < 0) client_close(c);
+        else client_watch(c);
+    }
+}
+
+// Send MIDI upstream for client from and echo it to the WebSocket clients
+int forward_midi(const client_t *from, const unsigned char *buf, size_t len) {
+    if (send_midi_bytes(buf, len) < 0) return -1;
+    ws_broadcast(from, buf, len);
+    return 0;
+}
+
+// Expand a MIDI byte stream into complete messages, each with its status
+// byte (running status resolved, SysEx dropped). out needs room for 2 * len
+// bytes (a one-data-byte message under running status doubles). Returns the
+// output length; *complete tells whether the input ended on a message
+// boundary.
+size_t midi_expand(midi_parser_t *p, const unsigned char *in, size_t len, unsigned char *out, int *complete) {
+    size_t n = 0;
+    int ended = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t msg[3];
+        int m = midi_parser_feed(p, in[i], msg);
+        memcpy(out + n, msg, m);
+        n += m;
+        ended = m > 0 || in[i] == 0xF7;
+    }
+    if (complete) *complete = ended;
+    return n;
+}
 
+// Send 3-byte raw MIDI message
+int send_midi_message(const client_t *from, unsigned char status, unsigned char data1, unsigned char data2) {
     unsigned char msg[3] = {status, data1, data2};
-    int result = (send(sock, msg, 3, MSG_NOSIGNAL) == 3) ? 0 : -1;
+    return forward_midi(from, msg, 3);
+}
 
-    close(sock);
-    return result;
+// Decode hex pairs ("903c64803c00") into buf; returns the byte count, or -1
+// if the string is empty, malformed or longer than max bytes
+int parse_hex(const char *p, unsigned char *buf, int max) {
+    int n = 0;
+    while (*p && *p != '&') {
+        int hi, lo;
+        if (n == max || sscanf(p, "%1x%1x", &hi, &lo) != 2) return -1;
+        buf[n++] = (unsigned char)(hi << 4 | lo);
+        p += 2;
+    }
+    return n > 0 ? n : -1;
 }
 
 // Parse query parameter from URL
@@ -77,54 +242,181 @@ int url_match(const char *url, const char *path) {
     return strncmp(url, path, strlen(path)) == 0;
 }
 
+// Value of a request header (after the colon and spaces), or NULL
+const char *header_value(const char *request, const char *name) {
+    size_t n = strlen(name);
+    const char *line = request;
+    while ((line = strchr(line, '\n')) != NULL) {
+        line++;
+        if (strncasecmp(line, name, n) != 0 || line[n] != ':') continue;
+        const char *v = line + n + 1;
+        while (*v == ' ') v++;
+        return v;
+    }
+    return NULL;
+}
+
+// Whether a header's comma-separated value contains token (any case)
+int header_has(const char *request, const char *name, const char *token) {
+    const char *v = header_value(request, name);
+    size_t n = strlen(token);
+    while (v && *v && *v != '\r') {
+        while (*v == ' ' || *v == ',') v++;
+        if (strncasecmp(v, token, n) == 0 && (v[n] == ',' || v[n] == ' ' || v[n] == '\r')) return 1;
+        while (*v && *v != ',' && *v != '\r') v++;
+    }
+    return 0;
+}
+
+// Ask-for-close and keep-alive: HTTP/1.1 keeps the connection unless the
+// client sends "Connection: close", HTTP/1.0 only with "Connection: keep-alive"
+int wants_close(const char *request) {
+    const char *eol = strchr(request, '\n');
+    int http10 = eol && eol - request >= 9 && strncmp(eol - 9, "HTTP/1.0", 8) == 0;
+    if (header_has(request, "Connection", "close")) return 1;
+    if (header_has(request, "Connection", "keep-alive")) return 0;
+    return http10;
+}
+
+// Content-Length of the request body (0 if absent)
+long content_length(const char *request) {
+    const char *v = header_value(request, "Content-Length");
+    return v ? strtol(v, NULL, 10) : 0;
+}
+
+// Queue a response on the client; it goes out in one send() once the
+// requests received so far have been handled
+void reply(client_t *c, const char *status, const char *headers, const char *body) {
+    size_t room = sizeof(c->out) - c->out_len;
+    int n = snprintf(c->out + c->out_len, room,
+        "HTTP/1.1 %s\r\n"
+        "%s"
+        "%s"
+        "Content-Length: %zu\r\n\r\n%s",
+        status, headers, c->close_after ? "Connection: close\r\n" : "", strlen(body), body);
+    if (n > 0 && (size_t)n < room) c->out_len += n;
+}
+
+// Answer the WebSocket opening handshake; later input is frames
+void ws_upgrade(client_t *c, const char *request) {
+    const char *key = header_value(request, "Sec-WebSocket-Key");
+    if (!key || c->close_after) {
+        reply(c, "400 Bad Request", "", "");
+        return;
+    }
+    size_t key_len = strcspn(key, "\r ");
+    char accept[WS_ACCEPT_LEN + 1];
+    ws_accept_key(key, key_len, accept);
+
+    int n = snprintf(c->out + c->out_len, sizeof(c->out) - c->out_len,
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+    if (n <= 0 || (size_t)n >= sizeof(c->out) - c->out_len) return;
+    c->out_len += n;
+    c->is_ws = 1;
+    midi_parser_init(&c->parser);
+
+    // Keepalive probes find browsers that vanished without a close frame
+    int one = 1;
+    setsockopt(c->fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+}
+
+// Start the closing handshake with a status code; the connection closes
+// once the close frame is out
+void ws_fail(client_t *c, int code) {
+    unsigned char status[2] = { (unsigned char)(code >> 8), (unsigned char)code };
+    ws_queue(c, WS_CLOSE, status, sizeof(status));
+    c->close_after = 1;
+}
+
+// Handle one frame at the start of buf; returns the bytes it used, or 0
+// if it is incomplete or the connection is closing
+size_t ws_process_frame(client_t *c, char *buf, size_t len) {
+    ws_frame_t f;
+    int n = ws_parse_frame((uint8_t *)buf, len, WS_MAX_PAYLOAD, &f);
+    if (n <= 0) {
+        if (n == WS_ERR_TOO_BIG) ws_fail(c, 1009);
+        else if (n < 0) ws_fail(c, 1002);
+        return 0;
+    }
+
+    switch (f.opcode) {
+    case WS_BINARY:
+        if (!f.fin) {
+            ws_fail(c, 1003);   // Fragmented messages are not reassembled
+            return 0;
+        }
+        if (f.len) {
+            unsigned char msgs[2 * WS_MAX_PAYLOAD];
+            size_t n = midi_expand(&c->parser, f.payload, f.len, msgs, NULL);
+            if (n) forward_midi(c, msgs, n);
+        }
+        break;
+    case WS_PING:
+        ws_queue(c, WS_PONG, f.payload, f.len);
+        break;
+    case WS_PONG:
+        break;
+    case WS_CLOSE:
+        // Echo the status code (if any) and close
+        ws_queue(c, WS_CLOSE, f.payload, f.len < 2 ? f.len : 2);
+        c->close_after = 1;
+        return 0;
+    default:
+        ws_fail(c, 1003);       // Text and continuation frames: not MIDI
+        return 0;
+    }
+    return n;
+}
+
 // Handle HTTP request
-void handle_request(int client_sock, const char *request) {
-    char response[256];
+void handle_request(client_t *c, const char *request) {
+    static const char *ok_headers =
+        "Access-Control-Allow-Origin: *\r\n"
+        "Content-Type: text/plain\r\n";
 
     // Handle OPTIONS method for CORS preflight
     if (strncmp(request, "OPTIONS", 7) == 0) {
-        snprintf(response, sizeof(response),
-            "HTTP/1.1 200 OK\r\n"
+        reply(c, "200 OK",
             "Access-Control-Allow-Origin: *\r\n"
             "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-            "Access-Control-Allow-Headers: Content-Type\r\n"
-            "Content-Length: 0\r\n\r\n");
-        send(client_sock, response, strlen(response), MSG_NOSIGNAL);
+            "Access-Control-Allow-Headers: Content-Type\r\n", "");
         return;
     }
 
     // Find GET/POST line
     const char *line_end = strchr(request, '\n');
-    if (!line_end) return;
 
     // Extract URL (between first space and second space)
     const char *url_start = strchr(request, ' ');
-    if (!url_start) return;
+    const char *url_end = url_start ? strchr(url_start + 1, ' ') : NULL;
+    if (!line_end || !url_end || url_end > line_end) {
+        reply(c, "400 Bad Request", "", "");
+        return;
+    }
     url_start++;
 
-    const char *url_end = strchr(url_start, ' ');
-    if (!url_end) return;
-
     char url[256];
-    int url_len = url_end - url_start;
+    size_t url_len = url_end - url_start;
     if (url_len >= sizeof(url)) url_len = sizeof(url) - 1;
     memcpy(url, url_start, url_len);
     url[url_len] = '\0';
 
     // Handle different endpoints
-    if (url_match(url, "/cc?")) {
+    if (strcmp(url, "/ws") == 0 && header_has(request, "Upgrade", "websocket")) {
+        ws_upgrade(c, request);
+        return;
+    }
+    else if (url_match(url, "/cc?")) {
         int cc = get_param(url, "cc", -1);
         int value = get_param(url, "value", -1);
 
         if (cc >= 0 && cc <= 127 && value >= 0 && value <= 127) {
             // MIDI CC: Status=0xB0 (channel 0), CC#, Value
-            if (send_midi_message(0xB0, cc, value) == 0) {
-                snprintf(response, sizeof(response),
-                    "HTTP/1.1 200 OK\r\n"
-                    "Access-Control-Allow-Origin: *\r\n"
-                    "Content-Type: text/plain\r\n"
-                    "Content-Length: 2\r\n\r\nOK");
-                send(client_sock, response, strlen(response), MSG_NOSIGNAL);
+            if (send_midi_message(c, 0xB0, cc, value) == 0) {
+                reply(c, "200 OK", ok_headers, "OK");
                 return;
             }
         }
@@ -138,55 +430,243 @@ void handle_request(int client_sock, const char *request) {
 
         if (note >= 0 && note <= 127 && velocity >= 0 && velocity <= 127) {
             unsigned char status = is_on ? 0x90 : 0x80;  // Note On/Off
-            if (send_midi_message(status, note, velocity) == 0) {
-                snprintf(response, sizeof(response),
-                    "HTTP/1.1 200 OK\r\n"
-                    "Access-Control-Allow-Origin: *\r\n"
-                    "Content-Type: text/plain\r\n"
-                    "Content-Length: 2\r\n\r\nOK");
-                send(client_sock, response, strlen(response), MSG_NOSIGNAL);
+            if (send_midi_message(c, status, note, velocity) == 0) {
+                reply(c, "200 OK", ok_headers, "OK");
                 return;
             }
         }
     }
+    else if (url_match(url, "/midi?")) {
+        // Raw MIDI batch, sent upstream as one write. Running status is
+        // allowed inside the batch, but it must start with a status byte
+        // and end on a message boundary; it goes out written in full, so
+        // it cannot bend another sender's messages on the shared stream.
+        unsigned char batch[MAX_BATCH], msgs[2 * MAX_BATCH];
+        const char *hex = strstr(url, "hex=");
+        int len = hex ? parse_hex(hex + 4, batch, MAX_BATCH) : -1;
+        midi_parser_t parser;
+        midi_parser_init(&parser);
+        int complete = 0;
+        size_t n = len > 0 ? midi_expand(&parser, batch, len, msgs, &complete) : 0;
+
+        if (len > 0 && (!(batch[0] & 0x80) || !complete || parser.dropped)) {
+            reply(c, "400 Bad Request", "", "");
+            return;
+        }
+        if (len > 0 && (n == 0 || forward_midi(c, msgs, n) == 0)) {     // SysEx only: nothing to send
+            reply(c, "200 OK", ok_headers, "OK");
+            return;
+        }
+    }
     else if (url_match(url, "/status")) {
-        snprintf(response, sizeof(response),
-            "HTTP/1.1 200 OK\r\n"
-            "Access-Control-Allow-Origin: *\r\n"
-            "Content-Type: text/plain\r\n"
-            "Content-Length: 2\r\n\r\nOK");
-        send(client_sock, response, strlen(response), MSG_NOSIGNAL);
+        reply(c, "200 OK", ok_headers, "OK");
         return;
     }
     else if (url_match(url, "/panic")) {
-        // Send Note Off for all 128 MIDI notes
-        int i;
-        for (i = 0; i < 128; i++) {
-            send_midi_message(0x80, i, 0);  // Note Off for note i
-        }
-        snprintf(response, sizeof(response),
-            "HTTP/1.1 200 OK\r\n"
-            "Access-Control-Allow-Origin: *\r\n"
-            "Content-Type: text/plain\r\n"
-            "Content-Length: 2\r\n\r\nOK");
-        send(client_sock, response, strlen(response), MSG_NOSIGNAL);
+        // All Sound Off (CC 120) and All Notes Off (CC 123) in one write;
+        // the engine is omni, so channel 0 reaches every voice
+        static const unsigned char panic[] = { 0xB0, 120, 0, 0xB0, 123, 0 };
+        forward_midi(c, panic, sizeof(panic));
+        reply(c, "200 OK", ok_headers, "OK");
         return;
     }
 
     // Default 404
-    snprintf(response, sizeof(response),
-        "HTTP/1.1 404 Not Found\r\n"
-        "Content-Length: 0\r\n\r\n");
-    send(client_sock, response, strlen(response), MSG_NOSIGNAL);
+    reply(c, "404 Not Found", "", "");
+}
+
+long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void client_close(client_t *c) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    c->fd = -1;
+}
+
+// Wait for input while the client keeps up, for output while its
+// responses are backed up
+void client_watch(client_t *c) {
+    struct epoll_event ev;
+    ev.events = c->out_len ? EPOLLOUT : EPOLLIN;
+    ev.data.u32 = c - clients;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+// Send queued responses; returns -1 if the client is gone
+int client_flush(client_t *c) {
+    size_t sent = 0;
+    while (sent < c->out_len) {
+        ssize_t n = send(c->fd, c->out + sent, c->out_len - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        sent += n;
+    }
+    memmove(c->out, c->out + sent, c->out_len - sent);
+    c->out_len -= sent;
+    return 0;
+}
+
+// Handle every complete request in the input buffer (a client may pipeline
+// several, or split one across reads); stops early while responses are
+// backed up so a client that does not read cannot grow without bound
+void client_process(client_t *c) {
+    size_t pos = 0;
+    while (!c->close_after && c->out_len < sizeof(c->out) / 2) {
+        if (c->is_ws) {
+            size_t used = ws_process_frame(c, c->in + pos, c->in_len - pos);
+            if (!used) break;
+            pos += used;
+            continue;
+        }
+
+        char *req = c->in + pos;
+        c->in[c->in_len] = '\0';
+        char *end = strstr(req, "\r\n\r\n");
+        if (!end) {
+            if (c->in_len - pos == BUFFER_SIZE) {
+                c->close_after = 1;                     // Headers larger than the buffer
+                reply(c, "431 Request Header Fields Too Large", "", "");
+            }
+            break;
+        }
+        size_t head = end + 4 - req;
+        end[2] = '\0';                                  // Request line and headers only
+        long body = content_length(req);
+        if (body < 0 || body > BUFFER_SIZE - (long)head) {
+            c->close_after = 1;
+            reply(c, "413 Payload Too Large", "", "");
+            break;
+        }
+        if (pos + head + body > c->in_len) {
+            end[2] = '\r';                              // Body still arriving
+            break;
+        }
+
+        c->close_after = wants_close(req);
+        handle_request(c, req);
+        pos += head + body;
+    }
+    memmove(c->in, c->in + pos, c->in_len - pos);
+    c->in_len -= pos;
+}
+
+// Handle buffered requests and send their responses until everything is
+// answered or the client stops reading; returns -1 if the client is gone
+int client_pump(client_t *c) {
+    for (;;) {
+        size_t before = c->in_len;
+        client_process(c);
+        if (client_flush(c) < 0) return -1;
+        if (c->out_len || c->close_after || c->in_len == before) return 0;
+    }
 }
 
-int main(void) {
-    struct sockaddr_in server_addr, client_addr;
-    socklen_t client_len;
-    char buffer[BUFFER_SIZE];
+// Done with this round: close, or wait for the next input or output
+void client_settle(client_t *c) {
+    c->last_ms = now_ms();
+    if (c->close_after && !c->out_len) client_close(c);
+    else client_watch(c);
+}
+
+void client_readable(client_t *c) {
+    while (!c->out_len && !c->close_after && c->in_len < BUFFER_SIZE) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, BUFFER_SIZE - c->in_len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) {
+            // Closed or reset: answer what arrived complete, then drop it
+            if (n == 0) client_pump(c);
+            client_close(c);
+            return;
+        }
+        c->in_len += n;
+        if (client_pump(c) < 0) {
+            client_close(c);
+            return;
+        }
+    }
+    client_settle(c);
+}
+
+void client_writable(client_t *c) {
+    if (client_flush(c) < 0 || (!c->out_len && client_pump(c) < 0)) {
+        client_close(c);
+        return;
+    }
+    client_settle(c);
+}
+
+void accept_clients(void) {
+    for (;;) {
+        int fd = accept(http_sock, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept");
+            return;
+        }
+
+        client_t *c = NULL;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) {
+                c = &clients[i];
+                break;
+            }
+        }
+        if (!c) {
+            close(fd);          // Full: the browser retries on a fresh connection
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        c->fd = fd;
+        c->in_len = c->out_len = 0;
+        c->close_after = c->is_ws = 0;
+        c->last_ms = now_ms();
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = c - clients;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            c->fd = -1;
+        }
+    }
+}
+
+// Drop connections idle for IDLE_TIMEOUT_MS (including clients stalled
+// halfway through a request) so they cannot hold slots forever
+void reap_idle(void) {
+    long long now = now_ms();
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0 && !clients[i].is_ws && now - clients[i].last_ms > IDLE_TIMEOUT_MS) client_close(&clients[i]);
+    }
+}
+
+int main(int argc, char **argv) {
+    struct sockaddr_in server_addr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) http_port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--midi-port") == 0 && i + 1 < argc) midi_port = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--port N] [--midi-port N]\n", argv[0]);
+            return 1;
+        }
+    }
 
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGPIPE, SIG_IGN);
 
     fprintf(stderr, "Rockit MIDI Bridge (C) starting...\n");
 
@@ -204,46 +684,68 @@ int main(void) {
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(HTTP_PORT);
+    server_addr.sin_port = htons(http_port);
 
     if (bind(http_sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
         perror("HTTP bind");
-        fprintf(stderr, "Port %d may already be in use. Kill existing process?\n", HTTP_PORT);
+        fprintf(stderr, "Port %d may already be in use. Kill existing process?\n", http_port);
         close(http_sock);
         return 1;
     }
 
-    if (listen(http_sock, 5) < 0) {
+    if (listen(http_sock, LISTEN_BACKLOG) < 0) {
         perror("HTTP listen");
         close(http_sock);
         return 1;
     }
+    fcntl(http_sock, F_SETFL, fcntl(http_sock, F_GETFL) | O_NONBLOCK);
 
-    fprintf(stderr, "HTTP server listening on port %d\n", HTTP_PORT);
-    fprintf(stderr, "Forwarding MIDI to %s:%d\n", MIDI_HOST, MIDI_PORT);
+    epoll_fd = epoll_create(MAX_CLIENTS + 1);
+    if (epoll_fd < 0) {
+        perror("epoll_create");
+        close(http_sock);
+        return 1;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = LISTENER;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, http_sock, &ev);
+    for (int i = 0; i < MAX_CLIENTS; i++) clients[i].fd = -1;
+
+    fprintf(stderr, "HTTP server listening on port %d (keep-alive, up to %d clients)\n", http_port, MAX_CLIENTS);
+    fprintf(stderr, "Forwarding MIDI to %s:%d\n", MIDI_HOST, midi_port);
     fprintf(stderr, "Press Ctrl+C to stop...\n");
 
+    struct epoll_event events[MAX_CLIENTS + 1];
     while (running) {
-        client_len = sizeof(client_addr);
-        int client_sock = accept(http_sock, (struct sockaddr*)&client_addr, &client_len);
-
-        if (client_sock < 0) {
-            if (running) perror("accept");
+        int n = epoll_wait(epoll_fd, events, MAX_CLIENTS + 1, 1000);
+        if (n < 0) {
+            if (errno != EINTR) perror("epoll_wait");
             continue;
         }
 
-        // Read HTTP request
-        ssize_t n = recv(client_sock, buffer, sizeof(buffer) - 1, 0);
-        if (n > 0) {
-            buffer[n] = '\0';
-            handle_request(client_sock, buffer);
+        for (int i = 0; i < n; i++) {
+            uint32_t id = events[i].data.u32;
+            if (id == LISTENER) {
+                accept_clients();
+                continue;
+            }
+            client_t *c = &clients[id];
+            if (c->fd < 0) continue;    // Closed earlier in this batch
+            if (events[i].events & EPOLLERR) client_close(c);
+            else if (events[i].events & EPOLLOUT) client_writable(c);
+            else client_readable(c);    // EPOLLIN or EPOLLHUP: recv() tells which
         }
-
-        close(client_sock);
+        reap_idle();
     }
 
     fprintf(stderr, "\nShutting down...\n");
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) close(clients[i].fd);
+    }
+    if (epoll_fd >= 0) close(epoll_fd);
     if (http_sock >= 0) close(http_sock);
+    midi_disconnect();
 
     return 0;
 }
@@ -0,0 +1,89 @@
+// Streaming MIDI byte parser, see midi_parser.h
+
+#include "midi_parser.h"
+#include <string.h>
+
+// Data bytes that follow a status byte (real-time and SysEx handled apart)
+static uint8_t data_length(uint8_t status){
+    switch(status & 0xF0){
+        case 0xC0:              // Program change
+        case 0xD0:              // Channel pressure
+            return 1;
+        case 0xF0:
+            switch(status){
+                case 0xF1:      // MTC quarter frame
+                case 0xF3:      // Song select
+                    return 1;
+                case 0xF2:      // Song position
+                    return 2;
+                default:        // Tune request, undefined
+                    return 0;
+            }
+        default:
+            return 2;
+    }
+}
+
+void midi_parser_init(midi_parser_t *p){
+    memset(p, 0, sizeof(*p));
+}
+
+int midi_parser_feed(midi_parser_t *p, uint8_t byte, uint8_t msg[3]){
+    if(byte >= 0xF8){
+        // Real-time: delivered at once, interrupts nothing
+        msg[0] = byte;
+        msg[1] = msg[2] = 0;
+        return 1;
+    }
+
+    if(byte & 0x80){
+        p->in_sysex = (byte == 0xF0);
+        p->count = 0;
+        if(byte >= 0xF0){
+            // System common (and SysEx start/end) cancel running status
+            p->status = 0;
+            if(byte == 0xF0 || byte == 0xF7 || byte == 0xF4 || byte == 0xF5) return 0;
+            if(data_length(byte) == 0){
+                msg[0] = byte;
+                msg[1] = msg[2] = 0;
+                return 1;
+            }
+        }
+        p->status = byte;
+        return 0;
+    }
+
+    // Data byte
+    if(p->in_sysex) return 0;
+    if(!p->status){
+        p->dropped++;
+        return 0;
+    }
+    p->data[p->count++] = byte;
+    uint8_t need = data_length(p->status);
+    if(p->count < need) return 0;
+
+    msg[0] = p->status;
+    msg[1] = p->data[0];
+    msg[2] = need > 1 ? p->data[1] : 0;
+    p->count = 0;
+    if(p->status >= 0xF0) p->status = 0;    // No running status for system common
+    return need + 1;
+}
+
+void midi_dispatch(const midi_handlers_t *h, const uint8_t msg[3]){
+    switch(msg[0] & 0xF0){
+        case 0x90:
+            if(msg[2] > 0){
+                if(h->note_on) h->note_on(msg[1]);
+                break;
+            }
+            // Fall through: velocity 0
+        case 0x80:
+            if(h->note_off) h->note_off(msg[1]);
+            break;
+        case 0xB0:
+            if(h->cc) h->cc(msg[1], msg[2]);
+            break;
+    }
+}
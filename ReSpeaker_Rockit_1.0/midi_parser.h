@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Streaming MIDI byte parser: turns a continuous byte stream (a persistent
+ * socket connection, a UART) back into messages.
+ *
+ * Channel messages may use running status. Real-time bytes (0xF8-0xFF) are
+ * delivered as one-byte messages wherever they appear, even inside another
+ * message or a SysEx, without disturbing it. SysEx (0xF0 ... 0xF7) is
+ * skipped; any status byte other than real-time ends it. System common
+ * messages are delivered and cancel running status. Data bytes with no
+ * status to attach to are dropped and counted.
+ */
+
+typedef struct {
+    uint8_t status;         // Running status (0 = none)
+    uint8_t data[2];
+    uint8_t count;          // Data bytes collected for status
+    uint8_t in_sysex;
+    uint32_t dropped;       // Stray data bytes
+} midi_parser_t;
+
+void midi_parser_init(midi_parser_t *p);
+
+// Feed one byte. When it completes a message, stores it in msg (unused
+// data bytes zero) and returns its length (1-3); otherwise returns 0.
+int midi_parser_feed(midi_parser_t *p, uint8_t byte, uint8_t msg[3]);
+
+// What the synth listens to; any handler may be NULL
+typedef struct {
+    void (*note_on)(uint8_t note);
+    void (*note_off)(uint8_t note);
+    void (*cc)(uint8_t cc, uint8_t value);
+} midi_handlers_t;
+
+// Hand a complete 3-byte message from midi_parser_feed() to the handlers,
+// on any channel. Note On with velocity 0 is a Note Off; other messages
+// are ignored.
+void midi_dispatch(const midi_handlers_t *h, const uint8_t msg[3]);
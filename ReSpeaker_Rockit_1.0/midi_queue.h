@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Wait-free single-producer/single-consumer MIDI event ring.
+ *
+ * Each input thread (socket, CLI, ...) owns one queue and pushes raw 3-byte
+ * MIDI messages stamped with CLOCK_MONOTONIC. The audio thread drains every
+ * attached queue at the start of a render call and applies each event at
+ * its sample offset inside the period (see rockit_engine_attach_queue()).
+ *
+ * head is only written by the producer, tail only by the consumer; they
+ * live on separate cache lines (32 bytes on the 24KEc) so the two threads
+ * do not bounce a line on every push/pop.
+ */
+
+#define MIDI_QUEUE_SIZE 256              // Must be a power of two
+#define MIDI_QUEUE_MASK (MIDI_QUEUE_SIZE - 1)
+
+typedef struct {
+    uint64_t t_ns;                       // CLOCK_MONOTONIC timestamp
+    uint8_t status, data1, data2;        // Raw MIDI message
+} midi_event_t;
+
+typedef struct {
+    midi_event_t ev[MIDI_QUEUE_SIZE];
+    uint32_t head __attribute__((aligned(32)));  // Next slot to write (producer)
+    uint32_t tail __attribute__((aligned(32)));  // Next slot to read (consumer)
+} midi_queue_t;
+
+static inline uint64_t midi_clock_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void midi_queue_init(midi_queue_t *q){
+    __atomic_store_n(&q->head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->tail, 0, __ATOMIC_RELAXED);
+}
+
+// Producer: push an event with an explicit timestamp. Returns -1 if full.
+static inline int midi_queue_push_at(midi_queue_t *q, uint64_t t_ns,
+                                     uint8_t status, uint8_t data1, uint8_t data2){
+    uint32_t h = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    if(h - t >= MIDI_QUEUE_SIZE) return -1;
+    midi_event_t *e = &q->ev[h & MIDI_QUEUE_MASK];
+    e->t_ns = t_ns;
+    e->status = status;
+    e->data1 = data1;
+    e->data2 = data2;
+    __atomic_store_n(&q->head, h + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Producer: push an event stamped with the current time. Returns -1 if full.
+static inline int midi_queue_push(midi_queue_t *q, uint8_t status, uint8_t data1, uint8_t data2){
+    return midi_queue_push_at(q, midi_clock_ns(), status, data1, data2);
+}
+
+// Consumer: oldest event, or NULL if the queue is empty
+static inline const midi_event_t *midi_queue_peek(midi_queue_t *q){
+    uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    uint32_t h = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    if(t == h) return NULL;
+    return &q->ev[t & MIDI_QUEUE_MASK];
+}
+
+// Consumer: release the event returned by midi_queue_peek()
+static inline void midi_queue_pop(midi_queue_t *q){
+    uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->tail, t + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,219 @@
+#include "midi_uart_raw.h"
+#include "midi_parser.h"
+#include "uart_baud.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <poll.h>
+#include <termios.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+#define UART_THREAD_STACK (64 * 1024)
+#define READ_CHUNK 64       // A 31250 baud line delivers ~3 bytes per ms
+#define POLL_MS 200         // Poll timeout: how soon midi_uart_raw_stop() is noticed
+
+static pthread_t th;
+static int running = 0;
+static int uart_fd = -1;
+static unsigned uart_baud = MIDI_UART_BAUD;
+static struct termios saved_tio;
+#if defined(__linux__) && defined(TIOCGSERIAL)
+static struct serial_struct saved_serial;   // Driver settings before start
+static int serial_changed = 0;
+#endif
+static midi_handlers_t handlers;
+
+static speed_t standard_speed(unsigned baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        default: return 0;
+    }
+}
+
+// Fallback for drivers without termios2 rates: program the UART divisor
+// directly (older 8250-style drivers) and select it with B38400. Returns 0
+// on success.
+static int set_custom_baud(int fd, unsigned baud) {
+#if defined(__linux__) && defined(TIOCGSERIAL) && defined(ASYNC_SPD_CUST)
+    struct serial_struct ss;
+    if (ioctl(fd, TIOCGSERIAL, &ss) < 0 || ss.baud_base <= 0) return -1;
+    saved_serial = ss;
+    ss.flags = (ss.flags & ~ASYNC_SPD_MASK) | ASYNC_SPD_CUST;
+    ss.custom_divisor = (ss.baud_base + (int)baud / 2) / (int)baud;
+    if (ss.custom_divisor < 1 || ioctl(fd, TIOCSSERIAL, &ss) < 0) return -1;
+    serial_changed = 1;
+    unsigned actual = (unsigned)(ss.baud_base / ss.custom_divisor);
+    if (actual * 100 < baud * 98 || actual * 100 > baud * 102) {
+        fprintf(stderr, "Warning: UART runs at %u baud for %u (divisor %d)\n", actual, baud, ss.custom_divisor);
+    }
+    return 0;
+#else
+    (void)fd; (void)baud;
+    return -1;
+#endif
+}
+
+// Hand bytes to user space as soon as they arrive rather than on the
+// driver's flip-buffer timer
+static void set_low_latency(int fd) {
+#if defined(__linux__) && defined(TIOCGSERIAL) && defined(ASYNC_LOW_LATENCY)
+    struct serial_struct ss;
+    if (ioctl(fd, TIOCGSERIAL, &ss) == 0 && !(ss.flags & ASYNC_LOW_LATENCY)) {
+        if (!serial_changed) saved_serial = ss;
+        ss.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(fd, TIOCSSERIAL, &ss) == 0) serial_changed = 1;
+    }
+#else
+    (void)fd;
+#endif
+}
+
+// Put back what uart_open() changed: the driver's serial_struct (custom
+// divisor, low latency) first, so B38400 means 38400 again, then termios
+static void uart_restore(int fd) {
+#if defined(__linux__) && defined(TIOCGSERIAL)
+    if (serial_changed) {
+        ioctl(fd, TIOCSSERIAL, &saved_serial);
+        serial_changed = 0;
+    }
+#endif
+    tcsetattr(fd, TCSANOW, &saved_tio);
+}
+
+// Raw 8N1 at the requested rate; read() returns as soon as one byte is in
+// (VMIN 1, VTIME 0: no inter-byte timer)
+static int uart_open(const char* path) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        perror("UART tcgetattr failed");
+        close(fd); return -1;
+    }
+    saved_tio = tio;
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    speed_t speed = standard_speed(uart_baud);
+    int custom = 0;
+    if (!speed) {
+        speed = B38400;     // Replaced by the termios2 rate or custom divisor
+        custom = 1;
+    }
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        perror("UART tcsetattr failed");
+        close(fd); return -1;
+    }
+    // 31250 baud is not a termios rate: ask for it through termios2
+    // (BOTHER) first, else through the old custom divisor on B38400.
+    // Staying at 38400 would turn a 31250 baud stream into garbage.
+    if (custom && uart_baud_set(fd, uart_baud) < 0 &&
+        (tcsetattr(fd, TCSANOW, &tio) < 0 || set_custom_baud(fd, uart_baud) < 0)) {
+        fprintf(stderr, "%s: cannot set %u baud (driver takes neither termios2 rates nor a custom divisor)\n", path, uart_baud);
+        uart_restore(fd);
+        close(fd); return -1;
+    }
+    set_low_latency(fd);
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
+
+static void* uart_thread(void* arg) {
+    (void)arg;
+    midi_parser_t parser;
+    midi_parser_init(&parser);
+    uint8_t buf[READ_CHUNK], msg[3];
+
+    while (running) {
+        struct pollfd pfd = { .fd = uart_fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, POLL_MS);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                perror("UART poll failed");
+                break;
+            }
+            continue;
+        }
+        if (ready == 0) continue;
+        if (pfd.revents & (POLLERR | POLLNVAL)) {
+            fprintf(stderr, "UART MIDI: device error, input stopped\n");
+            break;
+        }
+
+        ssize_t n = read(uart_fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            perror("UART read failed");
+            break;
+        }
+        if (n == 0) {
+            // Hangup (unplugged adapter, closed pty): wait instead of spinning
+            usleep(POLL_MS * 1000);
+            continue;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (midi_parser_feed(&parser, buf[i], msg) == 3) midi_dispatch(&handlers, msg);
+        }
+    }
+    return NULL;
+}
+
+void midi_uart_raw_set_baud(unsigned baud) {
+    uart_baud = baud;
+}
+
+int midi_uart_raw_start(const char* device_path,
+                        void (*on_note_on)(uint8_t),
+                        void (*on_note_off)(uint8_t),
+                        void (*on_cc)(uint8_t,uint8_t)) {
+    if (running) return 0;
+
+    uart_fd = uart_open(device_path);
+    if (uart_fd < 0) return -1;
+    handlers.note_on = on_note_on; handlers.note_off = on_note_off; handlers.cc = on_cc;
+    running = 1;
+
+    // Small explicit stack: the libc default (often 8 MB) would all be
+    // locked by main.c --realtime
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, UART_THREAD_STACK);
+    int err = pthread_create(&th, &attr, uart_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        fprintf(stderr, "UART thread creation failed: %s\n", strerror(err));
+        uart_restore(uart_fd);
+        close(uart_fd); uart_fd = -1; running = 0; return -1;
+    }
+    fprintf(stderr, "UART MIDI: %s at %u baud\n", device_path, uart_baud);
+    return 0;
+}
+
+void midi_uart_raw_stop(void) {
+    if (running) {
+        running = 0;
+        pthread_join(th, NULL);
+        uart_restore(uart_fd);
+        close(uart_fd);
+        uart_fd = -1;
+    }
+}
\ No newline at end of file
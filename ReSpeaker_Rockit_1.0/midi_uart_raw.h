@@ -1,10 +1,21 @@
 #pragma once
 #include <stdint.h>
 
-// Function to start monitoring a UART device file for raw MIDI data
+#define MIDI_UART_BAUD 31250
+
+// Function to start monitoring a UART device file for raw MIDI data: raw
+// mode, read with minimum latency and parsed as a byte stream (running
+// status, real-time bytes, SysEx skipped). Fails if the rate cannot be
+// set: 31250 baud needs a UART driver that takes termios2 (BOTHER) rates
+// or, failing that, a custom divisor.
 int midi_uart_raw_start(const char* device_path,
                         void (*on_note_on)(uint8_t), 
                         void (*on_note_off)(uint8_t),
                         void (*on_cc)(uint8_t,uint8_t));
                         
-void midi_uart_raw_stop(void);
\ No newline at end of file
+// Stops the reader and restores the line and driver settings
+void midi_uart_raw_stop(void);
+
+// Line rate before midi_uart_raw_start(): MIDI_UART_BAUD by default, e.g.
+// 38400 or 115200 for serial-to-MIDI bridges on a PC
+void midi_uart_raw_set_baud(unsigned baud);
\ No newline at end of file
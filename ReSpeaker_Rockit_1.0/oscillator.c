@@ -0,0 +1,626 @@
+/*
+ * Oscillator kernels - wavetable playback with mipmap anti-aliasing and the
+ * original Rockit's time-varying morph waveforms.
+ */
+#include "oscillator.h"
+#include "wavetables.h"
+#include <math.h>
+
+#ifdef ROCKIT_BL_TABLES
+// Mipmaps generated for the output rate by gen_wavetables (make BL_TABLES=1)
+#include "wavetables_bl.h"
+#if BL_LEN != 256 || BL_BITS != 8
+#error "The classic oscillator needs 256-entry 8-bit tables (gen_wavetables --len 256 --bits 8)"
+#endif
+#endif
+
+// Anti-aliasing: mipmap selection based on MIDI note
+static inline uint8_t get_mipmap_index(uint8_t note, uint8_t *blend_pos) {
+    *blend_pos = note & 0x03;  // note % 4
+    return note >> 2;           // note / 4
+}
+
+// Blend between adjacent mipmaps to prevent aliasing
+static inline uint8_t blend_mipmaps(const uint8_t table[][256], uint8_t mipmap, uint8_t blend_pos, uint8_t phase_idx) {
+    uint16_t sample;
+    
+    switch(blend_pos) {
+        case 0:  // 50% current + 50% below
+            if(mipmap == 0) return table[0][phase_idx];
+            sample = table[mipmap][phase_idx] + table[mipmap-1][phase_idx];
+            return sample >> 1;
+        case 1:  // 75% current + 25% below
+            if(mipmap == 0) return table[0][phase_idx];
+            sample = (table[mipmap][phase_idx] * 3) + table[mipmap-1][phase_idx];
+            return sample >> 2;
+        case 2:  // 75% current + 25% above
+            if(mipmap >= 31) return table[31][phase_idx];
+            sample = (table[mipmap][phase_idx] * 3) + table[mipmap+1][phase_idx];
+            return sample >> 2;
+        case 3:  // 50% current + 50% above
+            if(mipmap >= 31) return table[31][phase_idx];
+            sample = table[mipmap][phase_idx] + table[mipmap+1][phase_idx];
+            return sample >> 1;
+    }
+    return table[mipmap][phase_idx];
+}
+
+// Wavetable sampling with TIME-VARYING MORPHING (matches original Rockit firmware)
+// sq/ramp/tri: pre-blended tables for the note (see the cache below); only
+// the ones the waveform uses are valid
+// morph: pointer to per-voice morph state (updated each sample for time-varying behavior)
+// env_state: current envelope state for MORPH_9
+static inline int16_t wavetable_sample(uint32_t phase, wave_t w, uint8_t midi_note,
+                                       const uint8_t *sq, const uint8_t *ramp, const uint8_t *tri,
+                                       morph_state_t *morph, env_t env_state){
+    uint8_t mipmap = midi_note >> 2;
+    uint8_t i = (uint8_t)(phase >> 24);
+    uint8_t sample_u8;
+    uint16_t temp16;
+    int16_t stemp;
+
+    if(mipmap > 31) mipmap = 31;
+
+    switch(w){
+        case W_SINE:
+            sample_u8 = G_AUC_SIN_LUT[i];
+            break;
+
+        case W_SQUARE:
+            sample_u8 = sq[i];
+            break;
+
+        case W_SAW:
+            sample_u8 = ramp[i];
+            break;
+
+        case W_TRI:
+            sample_u8 = tri[i];
+            break;
+
+        case W_MORPH1:  // Square morphing with inverted ramp (offset 180°)
+            if(morph->morph_timer == 0) {
+                morph->morph_index++;
+                morph->morph_timer = 15;  // MORPH_1_TIME_PERIOD
+            }
+            morph->morph_timer--;
+
+            temp16 = sq[i] * morph->morph_index;
+            temp16 += ramp[(uint8_t)(i + 127)] * (255 - morph->morph_index);
+            sample_u8 = temp16 >> 8;
+            break;
+
+        case W_MORPH2:  // Triangle with phase-shifting ramp
+            if(morph->morph_timer == 0) {
+                morph->morph_index++;
+                morph->morph_timer = 10;  // MORPH_2_TIME_PERIOD
+            }
+            morph->morph_timer--;
+
+            if(morph->phase_shift_timer == 0) {
+                morph->phase_shifter++;
+                morph->phase_shift_timer = 50;  // PHASE_SHIFT_TIMER_2
+            }
+            morph->phase_shift_timer--;
+
+            temp16 = tri[i] * morph->morph_index;
+            temp16 += ramp[(uint8_t)(i + morph->phase_shifter)] * (255 - morph->morph_index);
+            sample_u8 = temp16 >> 8;
+            break;
+
+        case W_MORPH3:  // Triangle minus reversed square (phase difference)
+            if(morph->morph_timer == 0) {
+                morph->morph_index++;
+                morph->morph_timer = 50;
+            }
+            morph->morph_timer--;
+
+            stemp = (int16_t)tri[i] -
+                    (int16_t)sq[(uint8_t)(i - morph->morph_index)];
+            sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
+            break;
+
+        case W_MORPH4:  // Sawtooth minus reversed sawtooth (bidirectional morph)
+            if(morph->morph_timer == 0) {
+                if(morph->morph_state == 0) {
+                    morph->morph_index++;
+                    if(morph->morph_index == 255) morph->morph_state = 1;
+                } else {
+                    morph->morph_index--;
+                    if(morph->morph_index == 0) morph->morph_state = 0;
+                }
+                morph->morph_timer = 250;
+            }
+            morph->morph_timer--;
+
+            stemp = (int16_t)ramp[i] -
+                    (int16_t)ramp[(uint8_t)(i - morph->morph_index)];
+            sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
+            break;
+
+        case W_MORPH5:  // Enveloped sine followed by enveloped square
+        case W_MORPH6:  // Enveloped ramp followed by enveloped square
+            if(morph->morph_timer == 0) {
+                morph->morph_index_16++;
+                morph->morph_timer = (w == W_MORPH5) ? 10 : 50;
+            }
+            morph->morph_timer--;
+
+            if(morph->morph_index_16 == 383) morph->morph_index_16 = 0;
+
+            temp16 = 0;
+            if(morph->morph_index_16 < 255) {
+                uint8_t base = (w == W_MORPH5) ? G_AUC_SIN_LUT[i] : ramp[i];
+                temp16 = (base * ramp[morph->morph_index_16 & 0xFF]) >> 8;
+            }
+            if(morph->morph_index_16 > 128 && morph->morph_index_16 < 383) {
+                uint8_t idx = morph->morph_index_16 - 128;
+                temp16 += (sq[i] * (255 - G_AUC_SIN_LUT[idx])) >> 8;
+            }
+            sample_u8 = (temp16 >> 1) & 0xFF;
+            break;
+
+        case W_MORPH7:  // Variable pulse width square (PWM)
+            if(morph->morph_timer == 0) {
+                morph->morph_index++;
+                morph->morph_timer = 25;
+            }
+            morph->morph_timer--;
+
+            stemp = (int16_t)ramp[i] -
+                    (int16_t)ramp[(uint8_t)(i - morph->morph_index)];
+            sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
+            break;
+
+        case W_MORPH8:  // Triangle→Noise→Narrowing pulse sequence
+            if(morph->morph_timer == 0) {
+                morph->morph_index++;
+                morph->morph_timer = 5;
+            }
+            morph->morph_timer--;
+
+            switch(morph->morph_state) {
+                case 0:  // Triangle for ~20ms
+                    sample_u8 = tri[i];
+                    if(morph->morph_index == 255) morph->morph_state = 1;
+                    break;
+                case 1:  // Noise for ~20ms
+                    if((i & 0x0F) == 0) {
+                        uint16_t bit = ((morph->lfsr >> 15) ^ (morph->lfsr >> 13) ^ (morph->lfsr >> 12) ^ (morph->lfsr >> 10)) & 1;
+                        morph->lfsr = (morph->lfsr << 1) | bit;
+                    }
+                    sample_u8 = morph->lfsr & 0xFF;
+                    if(morph->morph_index == 255) morph->morph_state = 2;
+                    break;
+                case 2:  // Narrowing pulse
+                case 3:  // Hold narrow pulse
+                    stemp = (int16_t)ramp[i] -
+                            (int16_t)ramp[(uint8_t)(i - morph->morph_index)];
+                    sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
+                    if(morph->morph_state == 2 && morph->morph_index == 255) morph->morph_state = 3;
+                    break;
+                default:
+                    sample_u8 = 128;
+            }
+            break;
+
+        case W_MORPH9:  // Envelope-following waveform
+            switch(env_state) {
+                case ENV_ATTACK:
+                    sample_u8 = tri[i];
+                    break;
+                case ENV_DECAY:
+                case ENV_SUSTAIN:
+                    stemp = (int16_t)ramp[i] -
+                            (int16_t)ramp[(uint8_t)(i - 127)];
+                    sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
+                    break;
+                default:  // Release
+                    if(morph->morph_timer == 0) {
+                        morph->morph_index++;
+                        morph->morph_timer = 10;
+                    }
+                    morph->morph_timer--;
+                    stemp = (int16_t)ramp[i] -
+                            (int16_t)ramp[(uint8_t)(i - morph->morph_index)];
+                    sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
+            }
+            break;
+
+        case W_HARDSYNC:  // Hard sync (uses 128-sample table, no blending)
+            // Hardsync table has 16 mipmaps with 128 samples each
+            // Use half the mipmap levels and half the phase resolution
+            {
+                uint8_t hs_mipmap = (mipmap >> 1) & 0x0F;  // Clamp to 0-15
+                uint8_t hs_phase = i >> 1;                  // 0-127 index
+                sample_u8 = G_AUC_HARDSYNC_2_WAVETABLE_LUT[hs_mipmap][hs_phase];
+            }
+            break;
+
+        case W_NOISE:  // LFSR-based pseudo-random noise
+            if((i & 0x0F) == 0) {
+                uint16_t bit = ((morph->lfsr >> 15) ^ (morph->lfsr >> 13) ^ (morph->lfsr >> 12) ^ (morph->lfsr >> 10)) & 1;
+                morph->lfsr = (morph->lfsr << 1) | bit;
+            }
+            sample_u8 = morph->lfsr & 0xFF;
+            break;
+
+        case W_RAW_SQUARE:  // Raw aliasing square
+            sample_u8 = (i < 128) ? 255 : 0;
+            break;
+
+        default:
+            sample_u8 = G_AUC_SIN_LUT[i];
+            break;
+    }
+
+    return ((int16_t)sample_u8 - 128) << 7;
+}
+
+// ============================================================================
+// PRE-BLENDED TABLE CACHE
+// ============================================================================
+// blend_mipmaps() depends only on (table, note), so each pair is blended once
+// into a 256-byte table and every later sample is a single byte load. A small
+// global LRU keeps recently used pairs; voices hold slot indices that are
+// re-validated against the slot key once per block, so an evicted slot is
+// simply rebuilt. Each engine owns its cache (osc_cache_t), so engines can
+// render on different threads.
+
+// Pre-blended tables each waveform reads
+#define TAB_SQ   (1u << OSC_TAB_SQUARE)
+#define TAB_RAMP (1u << OSC_TAB_RAMP)
+#define TAB_TRI  (1u << OSC_TAB_TRI)
+static const uint8_t WAVE_TABS[16] = {
+    [W_SQUARE] = TAB_SQ,            [W_SAW] = TAB_RAMP,             [W_TRI] = TAB_TRI,
+    [W_MORPH1] = TAB_SQ | TAB_RAMP, [W_MORPH2] = TAB_TRI | TAB_RAMP, [W_MORPH3] = TAB_TRI | TAB_SQ,
+    [W_MORPH4] = TAB_RAMP,          [W_MORPH5] = TAB_RAMP | TAB_SQ, [W_MORPH6] = TAB_RAMP | TAB_SQ,
+    [W_MORPH7] = TAB_RAMP,          [W_MORPH8] = TAB_TRI | TAB_RAMP, [W_MORPH9] = TAB_TRI | TAB_RAMP,
+};
+
+#ifdef ROCKIT_BL_TABLES
+// Generated tables already have one level per note: no blending, no cache
+static const uint8_t (*const BL_TAB_SRC[OSC_TAB_COUNT])[256] = {
+    [OSC_TAB_SQUARE] = BL_SQUARE,
+    [OSC_TAB_RAMP]   = BL_RAMP,
+    [OSC_TAB_TRI]    = BL_TRIANGLE,
+};
+
+static const uint8_t *osc_cache_get(osc_tables_t *t, osc_tab_t tab){
+    return BL_TAB_SRC[tab][BL_NOTE_LEVEL[t->note]];
+}
+
+void osc_cache_init(osc_cache_t *c){
+    c->unused = 0;
+}
+
+int osc_table_rate(void){
+    return BL_RATE;
+}
+#else
+int osc_table_rate(void){
+    return 0;
+}
+
+static const uint8_t (*const OSC_TAB_SRC[OSC_TAB_COUNT])[256] = {
+    [OSC_TAB_SQUARE] = G_AUC_SQUARE_WAVETABLE_LUT,
+    [OSC_TAB_RAMP]   = G_AUC_RAMP_WAVETABLE_LUT,
+    [OSC_TAB_TRI]    = G_AUC_TRIANGLE_WAVETABLE_LUT,
+};
+
+static const uint8_t *osc_cache_get(osc_tables_t *t, osc_tab_t tab){
+    uint16_t key = (uint16_t)(((unsigned)tab << 8 | t->note) + 1);
+    osc_cache_entry_t *cache = t->cache->entry;
+    osc_cache_entry_t *e = &cache[t->slot[tab]];
+
+    if(e->key != key){
+        // Not bound yet or evicted: find the pair, else rebuild the LRU slot
+        int victim = 0;
+        int found = -1;
+        for(int i=0; i<OSC_CACHE_SLOTS; i++){
+            if(cache[i].key == key){ found = i; break; }
+            if(cache[i].stamp < cache[victim].stamp) victim = i;
+        }
+        if(found < 0){
+            uint8_t blend_pos;
+            uint8_t mipmap = get_mipmap_index(t->note, &blend_pos);
+            if(mipmap > 31) mipmap = 31;
+            e = &cache[victim];
+            for(int i=0; i<256; i++)
+                e->data[i] = blend_mipmaps(OSC_TAB_SRC[tab], mipmap, blend_pos, (uint8_t)i);
+            e->key = key;
+            found = victim;
+        }
+        t->slot[tab] = (uint8_t)found;
+        e = &cache[found];
+    }
+    e->stamp = ++t->cache->clock;
+    return e->data;
+}
+
+void osc_cache_init(osc_cache_t *c){
+    for(int i=0; i<OSC_CACHE_SLOTS; i++){
+        c->entry[i].key = 0;
+        c->entry[i].stamp = 0;
+    }
+    c->clock = 0;
+}
+#endif
+
+void osc_tables_bind(osc_tables_t *t, osc_cache_t *cache, uint8_t midi_note){
+    t->cache = cache;
+    t->note = midi_note & 0x7F;
+    for(int i=0; i<OSC_TAB_COUNT; i++)
+        t->slot[i] = 0;  // Any in-range slot; the key check does the rest
+}
+
+// ============================================================================
+// HIGH-RESOLUTION TABLES (OSC_ENGINE_HQ)
+// ============================================================================
+// 1024-sample int16 tables, band-limited per octave of phase increment, read
+// with linear interpolation on 15 fractional phase bits. Level k serves
+// inc < 2^(22+k) (level 0 is everything below ~47 Hz at 48 kHz) and holds
+// the harmonics that stay under Nyquist for the fastest inc it serves, so
+// the same tables are correct at any sample rate.
+//
+// Each entry packs t[i] (low half) and t[i+1] (high half): one 32-bit load
+// feeds the paired Q15 multiply (dpaq_s.w.ph) that does the interpolation.
+
+#define HQ_BITS        10
+#define HQ_LEN         (1 << HQ_BITS)
+#define HQ_LEVELS      10
+#define HQ_LEVEL_SHIFT 22
+#define HQ_PEAK        16383   // Same peak level as the classic tables
+
+static uint32_t HQ_SINE[HQ_LEN];
+static uint32_t HQ_TAB[OSC_TAB_COUNT][HQ_LEVELS][HQ_LEN];
+
+#if defined(__mips_dsp)
+typedef short hq_v2q15 __attribute__((vector_size(4)));
+// a*(1-f) + b*f in the DSP accumulator, rounded back to Q15
+static inline int16_t hq_interp(uint32_t pair, int32_t frac){
+    uint32_t w = ((uint32_t)frac << 16) | (uint32_t)(32767 - frac);
+    long long acc = __builtin_mips_dpaq_s_w_ph(0, (hq_v2q15)pair, (hq_v2q15)w);
+    return (int16_t)__builtin_mips_extr_r_w(acc, 16);
+}
+#else
+// Portable equivalent (host builds, tests)
+static inline int16_t hq_interp(uint32_t pair, int32_t frac){
+    int32_t a = (int16_t)pair;
+    int32_t b = (int16_t)(pair >> 16);
+    return (int16_t)(a + (((b - a) * frac) >> 15));
+}
+#endif
+
+static void hq_pack(uint32_t *dst, const int32_t *src){
+    for(int i=0; i<HQ_LEN; i++)
+        dst[i] = (uint16_t)src[i] | ((uint32_t)(uint16_t)src[(i + 1) & (HQ_LEN - 1)] << 16);
+}
+
+// Fourier series in the classic tables' phase/polarity: falling ramp,
+// square high for the first half, triangle peaking at a quarter cycle.
+// amp_q16[h] = 0 for absent harmonics.
+static void hq_series(int64_t *acc, const int16_t *sinq, osc_tab_t tab, int harmonics){
+    for(int i=0; i<HQ_LEN; i++) acc[i] = 0;
+    for(int h=1; h<=harmonics; h++){
+        int32_t amp;
+        switch(tab){
+            case OSC_TAB_RAMP:   amp = 65536 / h; break;
+            case OSC_TAB_SQUARE: amp = (h & 1) ? 65536 / h : 0; break;
+            default:             amp = (h & 1) ? ((h & 2) ? -1 : 1) * (65536 / (h * h)) : 0; break;
+        }
+        if(!amp) continue;
+        for(int i=0; i<HQ_LEN; i++)
+            acc[i] += (int64_t)amp * sinq[(h * i) & (HQ_LEN - 1)];
+    }
+}
+
+void osc_hq_init(void){
+    // 0 = not built, 1 = building, 2 = ready
+    static int state = 0;
+    static int16_t sinq[HQ_LEN];
+    static int64_t acc[HQ_LEN];
+    static int32_t tmp[HQ_LEN];
+    int expected = 0;
+    if(!__atomic_compare_exchange_n(&state, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+        while(__atomic_load_n(&state, __ATOMIC_ACQUIRE) != 2)
+            ;
+        return;
+    }
+
+    for(int i=0; i<HQ_LEN; i++)
+        sinq[i] = (int16_t)lrintf(sinf(6.2831853f * (float)i / HQ_LEN) * 32767.0f);
+    for(int i=0; i<HQ_LEN; i++) tmp[i] = (sinq[i] * HQ_PEAK) / 32767;
+    hq_pack(HQ_SINE, tmp);
+
+    for(int tab=0; tab<OSC_TAB_COUNT; tab++){
+        // One scale per shape (from the fullest level) so switching levels
+        // never changes loudness
+        int64_t peak = 1;
+        hq_series(acc, sinq, (osc_tab_t)tab, HQ_LEN / 2 - 1);
+        for(int i=0; i<HQ_LEN; i++){
+            int64_t a = acc[i] < 0 ? -acc[i] : acc[i];
+            if(a > peak) peak = a;
+        }
+
+        for(int k=0; k<HQ_LEVELS; k++){
+            // Highest harmonic below Nyquist at inc = 2^(22+k), with ~6% guard
+            int harmonics = ((1 << (31 - HQ_LEVEL_SHIFT - k)) * 15) / 16;
+            if(harmonics > HQ_LEN / 2 - 1) harmonics = HQ_LEN / 2 - 1;
+            if(harmonics < 1) harmonics = 1;
+            hq_series(acc, sinq, (osc_tab_t)tab, harmonics);
+            for(int i=0; i<HQ_LEN; i++)
+                tmp[i] = (int32_t)(acc[i] * HQ_PEAK / peak);
+            hq_pack(HQ_TAB[tab][k], tmp);
+        }
+    }
+    __atomic_store_n(&state, 2, __ATOMIC_RELEASE);
+}
+
+static void osc_hq_render_block(int16_t *out, size_t n, uint32_t *phase, uint32_t inc, wave_t w){
+    uint32_t ph = *phase;
+    const uint32_t *t = HQ_SINE;
+    if(w != W_SINE){
+        int k = (inc >> HQ_LEVEL_SHIFT) ? 32 - __builtin_clz(inc >> HQ_LEVEL_SHIFT) : 0;
+        if(k >= HQ_LEVELS) k = HQ_LEVELS - 1;
+        t = HQ_TAB[(w == W_SQUARE) ? OSC_TAB_SQUARE : (w == W_SAW) ? OSC_TAB_RAMP : OSC_TAB_TRI][k];
+    }
+    for(size_t i=0; i<n; i++, ph+=inc)
+        out[i] = hq_interp(t[ph >> (32 - HQ_BITS)], (int32_t)((ph >> (32 - HQ_BITS - 15)) & 0x7FFF));
+    *phase = ph;
+}
+
+// ============================================================================
+// POLYBLEP OSCILLATORS (OSC_ENGINE_BLEP)
+// ============================================================================
+// Naive shapes straight from the phase accumulator, with each discontinuity
+// smoothed by a 2-sample polynomial residual: PolyBLEP at steps (pulse, saw)
+// and PolyBLAMP at slope changes (triangle). No table memory, so the D-cache
+// is left to the morph waveforms, and the pulse width can move every block.
+// Phase and polarity match the classic tables.
+//
+// Only samples within one increment of an edge pay for a correction; the
+// distance to the edge in samples comes from a per-block reciprocal of inc.
+
+#define BLEP_AMP     13900   // Flat level of the band-limited square/saw tables
+#define BLEP_TRI_AMP 16383   // Triangle peak, as in the tables
+
+uint32_t osc_pulse_width(int knob){
+    if(knob < 0) knob = 0;
+    if(knob > 127) knob = 127;
+    return (uint32_t)(((uint64_t)(knob + 8) << 32) / 144);
+}
+
+// Signed 1 - |distance to edge| in samples, Q15: > 0 just after the edge,
+// < 0 just before it, 0 when more than one increment away
+static inline int32_t blep_near(uint32_t ph, uint32_t edge, uint32_t inc, uint32_t rinc){
+    uint32_t d = ph - edge;
+    if(d < inc) return 32768 - (int32_t)(((uint64_t)d * rinc) >> 32);
+    d = edge - ph;
+    if(d < inc) return -(32768 - (int32_t)(((uint64_t)d * rinc) >> 32));
+    return 0;
+}
+
+// PolyBLEP residual of an upward step from -BLEP_AMP to +BLEP_AMP
+static inline int32_t blep_step(int32_t u){
+    int32_t a = u < 0 ? -u : u;
+    return -((BLEP_AMP * ((u * a) >> 15)) >> 15);
+}
+
+// PolyBLAMP magnitude for a slope change of k (Q15, see below)
+static inline int32_t blep_ramp(int32_t u, int32_t k){
+    int32_t a = u < 0 ? -u : u;
+    int32_t a3 = (((a * a) >> 15) * a) >> 15;
+    return (int32_t)(((int64_t)k * a3) >> 30);
+}
+
+static void osc_blep_render_block(int16_t *out, size_t n, uint32_t *phase, uint32_t inc,
+                                  uint32_t width, wave_t w){
+    uint32_t ph = *phase;
+    // 2^47 / inc: edge distance d (< inc) times rinc >> 32 is d/inc in Q15
+    uint32_t rinc = (inc > 0x10000) ? (uint32_t)((1ull << 47) / inc) : 0xFFFFFFFFu;
+
+    switch(w){
+        case W_SAW:
+            // Falling ramp, upward step at the wrap
+            for(size_t i=0; i<n; i++, ph+=inc){
+                int32_t s = BLEP_AMP - (int32_t)(((ph >> 16) * (2 * BLEP_AMP)) >> 16);
+                int32_t u = blep_near(ph, 0, inc, rinc);
+                if(u) s += blep_step(u);
+                out[i] = (int16_t)s;
+            }
+            break;
+
+        case W_TRI: {
+            // Peak at a quarter cycle, trough at three quarters; each corner
+            // is a slope change of 8*amp per cycle = 8*amp*inc/2^32 per sample,
+            // and the BLAMP residual is that times (1-|t|)^3/6
+            int32_t k = (int32_t)(((uint64_t)inc * (4 * BLEP_TRI_AMP / 3)) >> 17);
+            for(size_t i=0; i<n; i++, ph+=inc){
+                uint32_t d = ph - 0x40000000u;
+                uint32_t a = (d & 0x80000000u) ? 0u - d : d;
+                int32_t s = BLEP_TRI_AMP - (int32_t)(((a >> 15) * BLEP_TRI_AMP) >> 15);
+                int32_t u = blep_near(ph, 0x40000000u, inc, rinc);
+                if(u) s -= blep_ramp(u, k);
+                u = blep_near(ph, 0xC0000000u, inc, rinc);
+                if(u) s += blep_ramp(u, k);
+                out[i] = (int16_t)s;
+            }
+            break;
+        }
+
+        default:
+            // Pulse: high until width, upward step at the wrap
+            for(size_t i=0; i<n; i++, ph+=inc){
+                int32_t s = (ph < width) ? BLEP_AMP : -BLEP_AMP;
+                int32_t u = blep_near(ph, 0, inc, rinc);
+                if(u) s += blep_step(u);
+                u = blep_near(ph, width, inc, rinc);
+                if(u) s -= blep_step(u);
+                out[i] = (int16_t)s;
+            }
+            break;
+    }
+    *phase = ph;
+}
+
+void osc_render_block(int16_t *out, size_t n, uint32_t *phase, uint32_t inc, osc_engine_t engine,
+                      uint32_t width, wave_t w, osc_tables_t *tabs, morph_state_t *morph, env_t env_state){
+    uint32_t ph = *phase;
+    if(w > 15) w = W_SINE;
+
+    if(engine == OSC_ENGINE_HQ && w <= W_TRI){
+        osc_hq_render_block(out, n, phase, inc, w);
+        return;
+    }
+    if(engine == OSC_ENGINE_BLEP && (w == W_SQUARE || w == W_SAW || w == W_TRI || w == W_RAW_SQUARE)){
+        osc_blep_render_block(out, n, phase, inc, width, w);
+        return;
+    }
+
+    // Resolve the pre-blended tables this waveform needs, once per block
+    const uint8_t *sq = NULL, *ramp = NULL, *tri = NULL;
+    uint8_t need = WAVE_TABS[w];
+    if(need & TAB_SQ) sq = osc_cache_get(tabs, OSC_TAB_SQUARE);
+    if(need & TAB_RAMP) ramp = osc_cache_get(tabs, OSC_TAB_RAMP);
+    if(need & TAB_TRI) tri = osc_cache_get(tabs, OSC_TAB_TRI);
+
+    switch(w){
+        case W_SINE:
+            for(size_t i=0; i<n; i++, ph+=inc)
+                out[i] = ((int16_t)G_AUC_SIN_LUT[ph >> 24] - 128) << 7;
+            break;
+
+        case W_SQUARE:
+        case W_SAW:
+        case W_TRI: {
+            const uint8_t *t = sq ? sq : ramp ? ramp : tri;
+            for(size_t i=0; i<n; i++, ph+=inc)
+                out[i] = ((int16_t)t[ph >> 24] - 128) << 7;
+            break;
+        }
+
+        case W_HARDSYNC: {
+            // Hardsync table has 16 mipmaps with 128 samples each
+            uint8_t mipmap = tabs->note >> 2;
+            if(mipmap > 31) mipmap = 31;
+            const uint8_t *row = G_AUC_HARDSYNC_2_WAVETABLE_LUT[(mipmap >> 1) & 0x0F];
+            for(size_t i=0; i<n; i++, ph+=inc)
+                out[i] = ((int16_t)row[ph >> 25] - 128) << 7;
+            break;
+        }
+
+        case W_RAW_SQUARE:
+            for(size_t i=0; i<n; i++, ph+=inc)
+                out[i] = (ph < width) ? 16256 : -16384;
+            break;
+
+        default:
+            // Morphing and noise waveforms carry per-sample state
+            for(size_t i=0; i<n; i++, ph+=inc)
+                out[i] = wavetable_sample(ph, w, tabs->note, sq, ramp, tri, morph, env_state);
+            break;
+    }
+
+    *phase = ph;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "envelope.h"
+
+// Wave types - 16 matching original Rockit manual
+typedef enum {
+    W_SINE=0, W_SQUARE=1, W_SAW=2, W_TRI=3,
+    W_MORPH1=4, W_MORPH2=5, W_MORPH3=6, W_MORPH4=7,
+    W_MORPH5=8, W_MORPH6=9, W_MORPH7=10, W_MORPH8=11,
+    W_MORPH9=12, W_HARDSYNC=13, W_NOISE=14, W_RAW_SQUARE=15
+} wave_t;
+
+// Oscillator engines (P_OSC_ENGINE)
+typedef enum {
+    OSC_ENGINE_CLASSIC=0,   // Original 8-bit mipmap tables, 8-bit phase
+    OSC_ENGINE_HQ=1,        // 16-bit band-limited tables, interpolated phase
+    OSC_ENGINE_BLEP=2       // PolyBLEP/PolyBLAMP from the phase accumulator, no tables
+} osc_engine_t;
+
+// Pulse width as a phase (0x80000000 = square) for P_PULSE_WIDTH 0-127
+// (64 = square, 0/127 = ~6%/94%)
+uint32_t osc_pulse_width(int knob);
+
+// Per-voice morph state for time-varying waveforms (matches original Rockit)
+typedef struct {
+    uint8_t morph_timer;        // Sample counter for morph speed
+    uint8_t morph_index;        // 0-255 morph position
+    uint16_t morph_index_16;    // 0-65535 for longer morph cycles
+    uint8_t morph_state;        // State machine for complex morphs (MORPH_8, MORPH_4)
+    uint8_t phase_shifter;      // Phase offset for MORPH_2
+    uint8_t phase_shift_timer;  // Timer for phase shifting
+    uint16_t lfsr;              // Per-voice LFSR for noise
+} morph_state_t;
+
+// Pre-blended wavetables (see oscillator.c): one 256-byte table per
+// (shape, note) pair, shared by all voices of an engine through an LRU cache
+#define OSC_CACHE_SLOTS 32
+
+typedef enum { OSC_TAB_SQUARE=0, OSC_TAB_RAMP, OSC_TAB_TRI, OSC_TAB_COUNT } osc_tab_t;
+
+#ifdef ROCKIT_BL_TABLES
+// Generated tables have one level per note (make BL_TABLES=1): nothing to cache
+typedef struct { uint8_t unused; } osc_cache_t;
+#else
+typedef struct {
+    uint16_t key;       // (tab << 8 | note) + 1, 0 = empty
+    uint32_t stamp;     // LRU clock value of the last use
+    uint8_t data[256] __attribute__((aligned(32)));  // Whole D-cache lines
+} osc_cache_entry_t;
+
+// One cache per engine, touched only by the thread rendering that engine
+typedef struct {
+    osc_cache_entry_t entry[OSC_CACHE_SLOTS];
+    uint32_t clock;     // Wraparound only perturbs eviction order
+} osc_cache_t;
+#endif
+
+void osc_cache_init(osc_cache_t *c);
+
+// Output rate the classic tables were generated for (make BL_TABLES=1
+// BL_RATE=...), or 0 for the original rate-independent tables
+int osc_table_rate(void);
+
+// Per-voice handle on the cache: the note plus the last slot seen per shape
+typedef struct {
+    osc_cache_t *cache;
+    uint8_t note;
+    uint8_t slot[OSC_TAB_COUNT];
+} osc_tables_t;
+
+// Point a voice at a new note (on note-on). Tables are built or found in the
+// cache the first time a waveform needs them, so a waveform change costs
+// at most one 256-byte blend per shape.
+void osc_tables_bind(osc_tables_t *t, osc_cache_t *cache, uint8_t midi_note);
+
+// Build the OSC_ENGINE_HQ tables. They are shared and read-only afterwards;
+// the first caller builds them (integer synthesis, safe without FPU) and
+// concurrent callers wait until they are complete.
+void osc_hq_init(void);
+
+/*
+ * Render a block of one oscillator into out[0..n-1] (Q15), advancing *phase
+ * by inc per sample. The waveform is dispatched once per block and the
+ * pre-blended tables it reads are resolved up front, so every table read in
+ * the inner loops is a single byte load. Morphing shapes still run their
+ * per-sample state machines. env_state is sampled once per block (used by
+ * W_MORPH9). width is the pulse width from osc_pulse_width().
+ *
+ * With OSC_ENGINE_HQ, sine/square/saw/triangle come from the 16-bit
+ * interpolated tables instead. With OSC_ENGINE_BLEP, square, saw, triangle
+ * and raw square are computed from the phase with PolyBLEP/PolyBLAMP
+ * corrections; square and raw square become a pulse of the given width.
+ * Every other waveform uses the classic path, whose raw square also follows
+ * width (without anti-aliasing).
+ */
+void osc_render_block(int16_t *out, size_t n, uint32_t *phase, uint32_t inc, osc_engine_t engine,
+                      uint32_t width, wave_t w, osc_tables_t *tabs, morph_state_t *morph, env_t env_state);
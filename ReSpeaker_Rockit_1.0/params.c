@@ -1,6 +1,12 @@
 #include "params.h"
 
-static int16_t V[P_COUNT];
+#ifndef ROCKIT_OSC_ENGINE
+#define ROCKIT_OSC_ENGINE 0
+#endif
+
+// snap_middle: buffer index plus a FRESH flag (see params_t)
+#define SNAP_INDEX 0x3u
+#define SNAP_FRESH 0x4u
 
 const param_spec_t PARAM_SPECS[P_COUNT] = {
   // Oscillators (0-15: 16 waveforms matching original Rockit)
@@ -9,6 +15,8 @@ const param_spec_t PARAM_SPECS[P_COUNT] = {
   [P_OSC_MIX]       = {"osc_mix",     0, 127, 64},
   [P_TUNE]          = {"tune",        0, 127, 64},  // Detune OSC2: 64=center, ±16 semitones (matches original Rockit)
   [P_SUBOSC]        = {"subosc",      0, 1,   0},  // 0:off 1:on
+  [P_OSC_ENGINE]    = {"osc_engine",  0, 2,   ROCKIT_OSC_ENGINE},  // Build default, see Makefile OSC=
+  [P_PULSE_WIDTH]   = {"pulse_width", 0, 127, 64},  // 64 = square
   
   // Envelope
   [P_ENV_ATTACK]    = {"attack",      0, 127, 4},
@@ -25,7 +33,7 @@ const param_spec_t PARAM_SPECS[P_COUNT] = {
   // LFO 1 (16 waveforms matching original Rockit)
   [P_LFO1_RATE]      = {"lfo1_rate",    0, 127, 32},
   [P_LFO1_DEPTH]     = {"lfo1_depth",   0, 127, 0},
-  [P_LFO1_DEST]      = {"lfo1_dest",    0, 5,   0},   // 6 destinations
+  [P_LFO1_DEST]      = {"lfo1_dest",    0, 6,   0},   // 7 destinations
   [P_LFO1_SHAPE]     = {"lfo1_shape",   0, 15,  0},   // 16 waveforms
   
   // LFO 2
@@ -46,19 +54,99 @@ const param_spec_t PARAM_SPECS[P_COUNT] = {
   [P_ARP_GATE]      = {"arp_gate",    0, 127, 100}, // Gate time percentage
 };
 
-void params_init(void){
-  for(int i=0; i<P_COUNT; i++)
-    V[i] = PARAM_SPECS[i].def;
+void params_init(params_t *p){
+  for(int i=0; i<P_COUNT; i++){
+    p->v[i] = PARAM_SPECS[i].def;
+    p->gen[i] = 0;
+  }
+  for(int b=0; b<3; b++){
+    for(int i=0; i<P_COUNT; i++){
+      p->snap[b].v[i] = p->v[i];
+      p->snap[b].gen[i] = 0;
+    }
+    p->snap[b].seq = 0;
+  }
+  p->snap_front = 0;
+  p->snap_back = 1;
+  __atomic_store_n(&p->snap_middle, 2, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&p->writes, 0, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&p->publishing, 0, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Copy the master values into the back buffer and swap it into 'middle'.
+ * Lock-free for any number of writers: whoever wins the 'publishing' flag
+ * publishes, a writer that loses just returns - the winner re-checks the
+ * write counter after releasing the flag and publishes again if anything
+ * landed meanwhile. Nobody ever waits.
+ */
+static void params_publish(params_t *p){
+  for(;;){
+    int expected = 0;
+    if(!__atomic_compare_exchange_n(&p->publishing, &expected, 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      return;
+
+    uint32_t seq = __atomic_load_n(&p->writes, __ATOMIC_SEQ_CST);
+    params_snapshot_t *b = &p->snap[p->snap_back];
+    for(int i=0; i<P_COUNT; i++){
+      b->v[i] = __atomic_load_n(&p->v[i], __ATOMIC_RELAXED);
+      b->gen[i] = __atomic_load_n(&p->gen[i], __ATOMIC_RELAXED);
+    }
+    b->seq = seq;
+    p->snap_back = __atomic_exchange_n(&p->snap_middle, p->snap_back | SNAP_FRESH, __ATOMIC_ACQ_REL) & SNAP_INDEX;
+
+    __atomic_store_n(&p->publishing, 0, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&p->writes, __ATOMIC_SEQ_CST) == seq) return;
+  }
 }
 
-void params_set(param_id_t id, int16_t val){
-  if(id < 0 || id >= P_COUNT) return;
+// Update the master copy; returns 1 if the value changed
+static int params_store(params_t *p, param_id_t id, int16_t val){
+  if(id < 0 || id >= P_COUNT) return 0;
   if(val < PARAM_SPECS[id].min) val = PARAM_SPECS[id].min;
   if(val > PARAM_SPECS[id].max) val = PARAM_SPECS[id].max;
-  V[id] = val;
+  if(__atomic_load_n(&p->v[id], __ATOMIC_RELAXED) == val) return 0;
+  __atomic_store_n(&p->v[id], val, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&p->gen[id], 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&p->writes, 1, __ATOMIC_SEQ_CST);
+  return 1;
+}
+
+void params_set(params_t *p, param_id_t id, int16_t val){
+  if(params_store(p, id, val)) params_publish(p);
 }
 
-int16_t params_get(param_id_t id){
+/*
+ * A batch holds the 'publishing' flag, so no other writer can publish the
+ * master copy while it is half updated. Those writers still never wait:
+ * they store and return, and params_batch_end() publishes their changes
+ * together with the batch. Only a second batch spins, for as long as one
+ * publish takes.
+ */
+void params_batch_begin(params_t *p){
+  int expected;
+  do {
+    expected = 0;
+  } while(!__atomic_compare_exchange_n(&p->publishing, &expected, 1, 1, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+}
+
+void params_stage(params_t *p, param_id_t id, int16_t val){
+  params_store(p, id, val);
+}
+
+void params_batch_end(params_t *p){
+  __atomic_store_n(&p->publishing, 0, __ATOMIC_SEQ_CST);
+  params_publish(p);
+}
+
+int16_t params_get(params_t *p, param_id_t id){
   if(id < 0 || id >= P_COUNT) return 0;
-  return V[id];
+  return __atomic_load_n(&p->v[id], __ATOMIC_RELAXED);
+}
+
+const params_snapshot_t *params_acquire(params_t *p){
+  if(__atomic_load_n(&p->snap_middle, __ATOMIC_RELAXED) & SNAP_FRESH){
+    p->snap_front = __atomic_exchange_n(&p->snap_middle, p->snap_front, __ATOMIC_ACQ_REL) & SNAP_INDEX;
+  }
+  return &p->snap[p->snap_front];
 }
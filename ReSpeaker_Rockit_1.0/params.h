@@ -8,6 +8,8 @@ typedef enum {
   P_OSC_MIX,
   P_TUNE,         // Detune OSC2: 0-127, center 64, ±16 semitones
   P_SUBOSC,
+  P_OSC_ENGINE,   // 0:Classic 8-bit tables 1:HQ 16-bit interpolated 2:PolyBLEP
+  P_PULSE_WIDTH,  // 0-127, 64 = square (PolyBLEP square and raw square)
   
   // Envelope
   P_ENV_ATTACK, 
@@ -24,7 +26,7 @@ typedef enum {
   // LFO 1 (16 waveforms matching original Rockit)
   P_LFO1_RATE, 
   P_LFO1_DEPTH, 
-  P_LFO1_DEST,    // 0:Amp 1:Filt 2:FiltQ 3:FiltEnv 4:Pitch 5:Detune
+  P_LFO1_DEST,    // 0:Amp 1:Filt 2:FiltQ 3:FiltEnv 4:Pitch 5:Detune 6:PulseWidth
   P_LFO1_SHAPE,   // 0-15: Sine,Sq,Saw,Tri,Morph1-9,HS,Noise,RawSq
   
   // LFO 2
@@ -54,6 +56,44 @@ typedef struct {
 
 extern const param_spec_t PARAM_SPECS[P_COUNT];
 
-void params_init(void);
-void params_set(param_id_t id, int16_t value);
-int16_t params_get(param_id_t id);
+/*
+ * Immutable parameter snapshot for the audio thread.
+ *
+ * Writers (socket/CLI threads) update a master copy and publish it into a
+ * triple buffer with an atomic index swap; the audio thread calls
+ * params_acquire() once per block and reads a consistent, unchanging view
+ * with plain loads. gen[] is bumped every time a parameter changes so the
+ * engine can recompute derived values only for parameters that moved.
+ */
+typedef struct {
+  int16_t v[P_COUNT];      // Parameter values
+  uint16_t gen[P_COUNT];   // Per-parameter generation counters
+  uint32_t seq;            // Publication sequence number
+} params_snapshot_t;
+
+// One parameter set (each engine owns one). Fields are private to params.c.
+typedef struct {
+  // Master copy written by params_set() (atomic per-parameter stores)
+  int16_t v[P_COUNT];
+  uint16_t gen[P_COUNT];
+  // Triple buffer: the reader owns 'front', the current publisher owns
+  // 'back', 'middle' holds the latest published snapshot plus a FRESH flag
+  params_snapshot_t snap[3];
+  unsigned snap_front;        // Audio thread only
+  unsigned snap_back;         // Only touched while holding 'publishing'
+  unsigned snap_middle;       // Atomic
+  uint32_t writes;            // Atomic: count of params_set() calls
+  int publishing;             // Atomic: 1 while a writer is publishing
+} params_t;
+
+void params_init(params_t *p);
+void params_set(params_t *p, param_id_t id, int16_t value);  // Any thread, lock-free
+int16_t params_get(params_t *p, param_id_t id);              // Latest value (control threads)
+const params_snapshot_t *params_acquire(params_t *p);        // Audio thread only, wait-free
+
+// Batch update (patch recall): the audio thread sees all the staged values
+// in one snapshot at params_batch_end(), never part of them. Keep file I/O
+// and other slow work outside the batch.
+void params_batch_begin(params_t *p);
+void params_stage(params_t *p, param_id_t id, int16_t value);   // Between begin and end only
+void params_batch_end(params_t *p);
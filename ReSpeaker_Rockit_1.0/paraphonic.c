@@ -0,0 +1,365 @@
+/*
+ * Rockit Paraphonic Voice Allocation Module - ReSpeaker Port
+// ... license text ...
+ */
+
+#include "paraphonic.h"
+#include <string.h>
+
+// Forward declarations
+static void allocate_voices_monophonic(paraphonic_state_t *ps);
+static void allocate_low_note_priority(paraphonic_state_t *ps);
+static void allocate_high_note_priority(paraphonic_state_t *ps);
+static void allocate_last_note_priority(paraphonic_state_t *ps);
+static void allocate_round_robin(paraphonic_state_t *ps);
+static void allocate_voices(paraphonic_state_t *ps);
+
+/*
+ * Initialize paraphonic system
+ */
+void paraphonic_init(paraphonic_state_t *ps) {
+    memset(ps, 0, sizeof(*ps));
+    ps->mode = MODE_LAST_NOTE;  // Last Note is usually a better default than Round Robin
+    ps->three_voice_mode = 1;     // Default: 3 voices enabled
+}
+
+/*
+ * Get current voice assignments (for synth engine)
+ */
+void paraphonic_get_voices(paraphonic_state_t *ps, voice_t* out_voices) {
+    memcpy(out_voices, ps->voices, sizeof(ps->voices));
+}
+
+/*
+ * Get voice mode
+ */
+voice_mode_t paraphonic_get_mode(paraphonic_state_t *ps) {
+    return ps->mode;
+}
+
+/*
+ * Set voice mode
+ */
+void paraphonic_set_mode(paraphonic_state_t *ps, voice_mode_t mode) {
+    if (mode < MODE_COUNT) {
+        ps->mode = mode;
+        allocate_voices(ps);
+    }
+}
+
+/*
+ * Set 3-voice mode
+ */
+void paraphonic_set_three_voice_mode(paraphonic_state_t *ps, uint8_t enabled) {
+    ps->three_voice_mode = enabled ? 1 : 0;
+    allocate_voices(ps);
+}
+
+/*
+ * Handle incoming MIDI note on
+ */
+void paraphonic_note_on(paraphonic_state_t *ps, uint8_t note, uint8_t velocity) {
+    // Check if already in stack (for retriggering)
+    for (uint8_t i = 0; i < ps->stack_size; i++) {
+        if (ps->note_stack[i] == note) {
+            // Already present, do nothing for now, or move to end for Last Note Priority
+            // Keeping it simple: just return
+            return;
+        }
+    }
+    
+    // Add to note stack if not full
+    if (ps->stack_size < 16) {
+        ps->note_stack[ps->stack_size] = note;
+        ps->velocity_stack[ps->stack_size] = velocity;
+        ps->stack_size++;
+    }
+    
+    allocate_voices(ps);
+}
+
+/*
+ * Handle incoming MIDI note off
+ */
+void paraphonic_note_off(paraphonic_state_t *ps, uint8_t note) {
+    // Remove from note stack
+    for (uint8_t i = 0; i < ps->stack_size; i++) {
+        if (ps->note_stack[i] == note) {
+            // Shift stack down
+            for (uint8_t j = i; j < ps->stack_size - 1; j++) {
+                ps->note_stack[j] = ps->note_stack[j + 1];
+                ps->velocity_stack[j] = ps->velocity_stack[j + 1];
+            }
+            ps->stack_size--;
+            break;
+        }
+    }
+    
+    allocate_voices(ps);
+}
+
+/*
+ * Forget every held note (All Notes Off / All Sound Off)
+ */
+void paraphonic_all_notes_off(paraphonic_state_t *ps) {
+    ps->stack_size = 0;
+    allocate_voices(ps);
+}
+
+/*
+ * Core voice allocation logic
+ */
+static void allocate_voices(paraphonic_state_t *ps) {
+    // Clear all voices first
+    for (uint8_t i = 0; i < 3; i++) {
+        ps->voices[i].active = 0;
+    }
+    
+    // If no notes, we're done
+    if (ps->stack_size == 0) {
+        return;
+    }
+    
+    switch (ps->mode) {
+        case MODE_MONOPHONIC:
+            allocate_voices_monophonic(ps);
+            break;
+        case MODE_LOW_NOTE:
+            allocate_low_note_priority(ps);
+            break;
+        case MODE_LAST_NOTE:
+            allocate_last_note_priority(ps);
+            break;
+        case MODE_ROUND_ROBIN:
+            allocate_round_robin(ps);
+            break;
+        case MODE_HIGH_NOTE:
+            allocate_high_note_priority(ps);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * Monophonic Mode: Most recent note plays
+ */
+static void allocate_voices_monophonic(paraphonic_state_t *ps) {
+    uint8_t note = ps->note_stack[ps->stack_size - 1];
+    uint8_t velocity = ps->velocity_stack[ps->stack_size - 1];
+    
+    ps->voices[0].note = note;
+    ps->voices[0].velocity = velocity;
+    ps->voices[0].active = 1;
+}
+
+/*
+ * Low Note Priority: Always play the N lowest notes
+ */
+static void allocate_low_note_priority(paraphonic_state_t *ps) {
+    // Sort notes (bubble sort)
+    uint8_t sorted_notes[16];
+    uint8_t sorted_vel[16];
+    
+    memcpy(sorted_notes, ps->note_stack, ps->stack_size);
+    memcpy(sorted_vel, ps->velocity_stack, ps->stack_size);
+    
+    for (uint8_t i = 0; i < ps->stack_size - 1; i++) {
+        for (uint8_t j = 0; j < ps->stack_size - i - 1; j++) {
+            if (sorted_notes[j] > sorted_notes[j + 1]) {
+                uint8_t temp = sorted_notes[j];
+                sorted_notes[j] = sorted_notes[j + 1];
+                sorted_notes[j + 1] = temp;
+                
+                temp = sorted_vel[j];
+                sorted_vel[j] = sorted_vel[j + 1];
+                sorted_vel[j + 1] = temp;
+            }
+        }
+    }
+    
+    // Assign to voices
+    uint8_t max_voices = ps->three_voice_mode ? 3 : 2;
+    uint8_t voices_to_assign = (ps->stack_size < max_voices) ? 
+                                ps->stack_size : max_voices;
+    
+    for (uint8_t i = 0; i < voices_to_assign; i++) {
+        ps->voices[i].note = sorted_notes[i];
+        ps->voices[i].velocity = sorted_vel[i];
+        ps->voices[i].active = 1;
+    }
+}
+
+/*
+ * High Note Priority: Always play the N highest notes
+ */
+static void allocate_high_note_priority(paraphonic_state_t *ps) {
+    // Sort notes in descending order
+    uint8_t sorted_notes[16];
+    uint8_t sorted_vel[16];
+    
+    memcpy(sorted_notes, ps->note_stack, ps->stack_size);
+    memcpy(sorted_vel, ps->velocity_stack, ps->stack_size);
+    
+    for (uint8_t i = 0; i < ps->stack_size - 1; i++) {
+        for (uint8_t j = 0; j < ps->stack_size - i - 1; j++) {
+            if (sorted_notes[j] < sorted_notes[j + 1]) {  // Descending
+                uint8_t temp = sorted_notes[j];
+                sorted_notes[j] = sorted_notes[j + 1];
+                sorted_notes[j + 1] = temp;
+                
+                temp = sorted_vel[j];
+                sorted_vel[j] = sorted_vel[j + 1];
+                sorted_vel[j + 1] = temp;
+            }
+        }
+    }
+    
+    // Assign to voices
+    uint8_t max_voices = ps->three_voice_mode ? 3 : 2;
+    uint8_t voices_to_assign = (ps->stack_size < max_voices) ? 
+                                ps->stack_size : max_voices;
+    
+    for (uint8_t i = 0; i < voices_to_assign; i++) {
+        ps->voices[i].note = sorted_notes[i];
+        ps->voices[i].velocity = sorted_vel[i];
+        ps->voices[i].active = 1;
+    }
+}
+
+/*
+ * Last Note Priority: Most recent notes get voices
+ */
+static void allocate_last_note_priority(paraphonic_state_t *ps) {
+    uint8_t max_voices = ps->three_voice_mode ? 3 : 2;
+    uint8_t voices_to_assign = (ps->stack_size < max_voices) ? 
+                                ps->stack_size : max_voices;
+    
+    // Assign most recent notes (from end of stack)
+    for (uint8_t i = 0; i < voices_to_assign; i++) {
+        uint8_t stack_idx = ps->stack_size - 1 - i;
+        ps->voices[i].note = ps->note_stack[stack_idx];
+        ps->voices[i].velocity = ps->velocity_stack[stack_idx];
+        ps->voices[i].active = 1;
+    }
+}
+
+/*
+ * Round Robin: Cycle through voices as notes arrive
+ * FIX: Simplifed allocation logic to directly assign from the note stack
+ */
+static void allocate_round_robin(paraphonic_state_t *ps) {
+    uint8_t max_voices = ps->three_voice_mode ? 3 : 2;
+    uint8_t voices_to_assign = (ps->stack_size < max_voices) ? 
+                                ps->stack_size : max_voices;
+    
+    if (ps->stack_size == 0) return;
+
+    // Use a temporary array to track which notes from the stack are currently assigned
+    uint8_t assigned_notes[3] = {0};
+    uint8_t assigned_count = 0;
+
+    // Preserve playing voices if the playing note is still in the stack
+    for(uint8_t i = 0; i < max_voices; ++i) {
+        uint8_t current_note = ps->voices[i].note;
+        if(ps->voices[i].active) {
+            // Check if this note is still held
+            for(uint8_t k = 0; k < ps->stack_size; ++k) {
+                if(ps->note_stack[k] == current_note) {
+                    assigned_notes[i] = current_note;
+                    assigned_count++;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Assign *newest* notes to available voices using round robin logic
+    for(uint8_t i = 0; i < voices_to_assign; ++i) {
+        uint8_t stack_idx = ps->stack_size - 1 - i;
+        uint8_t note = ps->note_stack[stack_idx];
+        uint8_t velocity = ps->velocity_stack[stack_idx];
+        
+        // Check if this note is already assigned (in assigned_notes array)
+        uint8_t already_assigned = 0;
+        for(uint8_t j = 0; j < max_voices; ++j) {
+            if(assigned_notes[j] == note) {
+                already_assigned = 1;
+                break;
+            }
+        }
+        
+        if (!already_assigned) {
+            // Find a voice to steal using the round robin pointer
+            uint8_t voice_to_steal = ps->rr_next_voice % max_voices;
+            
+            ps->voices[voice_to_steal].note = note;
+            ps->voices[voice_to_steal].velocity = velocity;
+            ps->voices[voice_to_steal].active = 1;
+            assigned_notes[voice_to_steal] = note; // Update temporary array
+
+            ps->rr_next_voice = (ps->rr_next_voice + 1) % max_voices;
+        }
+    }
+    
+    // Final assignment check (ensure active flag is set only for assigned notes)
+    for(uint8_t i = 0; i < max_voices; ++i) {
+        uint8_t note = ps->voices[i].note;
+        uint8_t is_held = 0;
+        for(uint8_t k = 0; k < ps->stack_size; ++k) {
+            if(ps->note_stack[k] == note) {
+                is_held = 1;
+                break;
+            }
+        }
+        ps->voices[i].active = is_held;
+    }
+}
+
+
+/*
+ * Handle MIDI CC for mode switching
+ */
+void paraphonic_handle_cc(paraphonic_state_t *ps, uint8_t cc, uint8_t value) {
+    switch (cc) {
+        case 102:  // Mono/Para (0-63=Mono, 64-127=Para)
+            if (value < 64) {
+                paraphonic_set_mode(ps, MODE_MONOPHONIC);
+            } else if (ps->mode == MODE_MONOPHONIC) {
+                paraphonic_set_mode(ps, MODE_LAST_NOTE);
+            }
+            break;
+            
+        case 103:  // 3-voice enable
+            paraphonic_set_three_voice_mode(ps, value >= 64);
+            break;
+            
+        case 104:  // Cycle para modes
+            if (ps->mode != MODE_MONOPHONIC) {
+                voice_mode_t next = ps->mode + 1;
+                if (next == MODE_MONOPHONIC || next >= MODE_COUNT) next = MODE_LOW_NOTE;
+                paraphonic_set_mode(ps, next);
+            } else {
+                paraphonic_set_mode(ps, MODE_LOW_NOTE);
+            }
+            break;
+            
+        case 105:  // 3-voice toggle
+            paraphonic_set_three_voice_mode(ps, value >= 64);
+            break;
+    }
+}
+
+/*
+ * Get mode name (for debugging/display)
+ */
+const char* paraphonic_get_mode_name(paraphonic_state_t *ps) {
+    switch (ps->mode) {
+        case MODE_MONOPHONIC:  return "Mono";
+        case MODE_LOW_NOTE:    return "Low Note";
+        case MODE_LAST_NOTE:   return "Last Note";
+        case MODE_ROUND_ROBIN: return "Round Robin";
+        case MODE_HIGH_NOTE:   return "High Note";
+        default:               return "Unknown";
+    }
+}
\ No newline at end of file
@@ -34,7 +34,7 @@ void patch_storage_init(void) {
 /**
  * Save current synth state to a patch slot
  */
-int patch_save(uint8_t patch_number) {
+int patch_save(params_t *p, uint8_t patch_number) {
     if (patch_number >= MAX_PATCHES) {
         fprintf(stderr, "patch_save: Invalid patch number %d\n", patch_number);
         return -1;
@@ -56,7 +56,7 @@ int patch_save(uint8_t patch_number) {
 
     // Save all parameters
     for (int i = 0; i < P_COUNT; i++) {
-        int16_t value = params_get((param_id_t)i);
+        int16_t value = params_get(p, (param_id_t)i);
         const char *name = PARAM_SPECS[i].name;
         fprintf(fp, "%s=%d\n", name, value);
     }
@@ -67,25 +67,18 @@ int patch_save(uint8_t patch_number) {
 }
 
 /**
- * Recall a patch from a slot
+ * Load a patch file (name=value lines) into a parameter set. The whole file
+ * is read first and applied as one batch, so the audio thread switches from
+ * the old patch to the new one between two blocks.
  */
-int patch_recall(uint8_t patch_number) {
-    if (patch_number >= MAX_PATCHES) {
-        fprintf(stderr, "patch_recall: Invalid patch number %d\n", patch_number);
-        return -1;
-    }
-
-    char path[256];
-    get_patch_path(patch_number, path, sizeof(path));
-
+int patch_load_file(params_t *p, const char *path) {
     FILE *fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "patch_recall: Patch %d does not exist\n", patch_number);
-        return -1;
-    }
+    if (!fp) return -1;
 
     char line[256];
     int params_loaded = 0;
+    int16_t values[P_COUNT];
+    uint8_t found[P_COUNT] = {0};
 
     while (fgets(line, sizeof(line), fp)) {
         // Skip comments and empty lines
@@ -99,12 +92,17 @@ int patch_recall(uint8_t patch_number) {
 
         *eq = '\0';  // Split string at '='
         const char *name = line;
-        int value = atoi(eq + 1);
+        long value = strtol(eq + 1, NULL, 10);
 
         // Find matching parameter
         for (int i = 0; i < P_COUNT; i++) {
             if (strcmp(PARAM_SPECS[i].name, name) == 0) {
-                params_set((param_id_t)i, (int16_t)value);
+                // Clamp before narrowing: volume=70000 must end up at the
+                // maximum, not wrap around
+                if (value < PARAM_SPECS[i].min) value = PARAM_SPECS[i].min;
+                if (value > PARAM_SPECS[i].max) value = PARAM_SPECS[i].max;
+                values[i] = (int16_t)value;
+                found[i] = 1;
                 params_loaded++;
                 break;
             }
@@ -113,6 +111,32 @@ int patch_recall(uint8_t patch_number) {
 
     fclose(fp);
 
+    params_batch_begin(p);
+    for (int i = 0; i < P_COUNT; i++) {
+        if (found[i]) params_stage(p, (param_id_t)i, values[i]);
+    }
+    params_batch_end(p);
+    return params_loaded;
+}
+
+/**
+ * Recall a patch from a slot
+ */
+int patch_recall(params_t *p, uint8_t patch_number) {
+    if (patch_number >= MAX_PATCHES) {
+        fprintf(stderr, "patch_recall: Invalid patch number %d\n", patch_number);
+        return -1;
+    }
+
+    char path[256];
+    get_patch_path(patch_number, path, sizeof(path));
+
+    int params_loaded = patch_load_file(p, path);
+    if (params_loaded < 0) {
+        fprintf(stderr, "patch_recall: Patch %d does not exist\n", patch_number);
+        return -1;
+    }
+
     if (params_loaded == 0) {
         fprintf(stderr, "patch_recall: No parameters loaded from patch %d\n", patch_number);
         return -1;
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include "params.h"
 
 /**
  * Patch Save/Recall System - ReSpeaker Port
@@ -24,20 +25,31 @@
 void patch_storage_init(void);
 
 /**
- * Save current synth state to a patch slot
+ * Save an engine's parameters to a patch slot
  *
+ * @param p Parameter set to save
  * @param patch_number Patch slot (0-15)
  * @return 0 on success, -1 on error
  */
-int patch_save(uint8_t patch_number);
+int patch_save(params_t *p, uint8_t patch_number);
 
 /**
- * Recall a patch from a slot
+ * Recall a patch from a slot into an engine's parameters
  *
+ * @param p Parameter set to load into
  * @param patch_number Patch slot (0-15)
  * @return 0 on success, -1 on error (patch doesn't exist or is invalid)
  */
-int patch_recall(uint8_t patch_number);
+int patch_recall(params_t *p, uint8_t patch_number);
+
+/**
+ * Load a patch file in the slot format from any path
+ *
+ * @param p Parameter set to load into
+ * @param path Patch file (name=value lines, '#' comments)
+ * @return Number of parameters loaded, -1 if the file cannot be opened
+ */
+int patch_load_file(params_t *p, const char *path);
 
 /**
  * Check if a patch exists
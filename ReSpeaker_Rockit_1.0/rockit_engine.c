@@ -1,13 +1,18 @@
 #include "rockit_engine.h"
-#include "paraphonic.h"
-#include "filter_svf.h"
 #include "patch_storage.h"
+#include "rt_guard.h"
 #include <string.h>
 #include <stdint.h>
 #include <math.h>
 #include <stdio.h>
 #include "wavetables.h"
 
+// Control block size in samples (see CONTROL-RATE MODULATION below); also
+// the voice block size
+#ifndef ROCKIT_CONTROL_BLOCK
+#define ROCKIT_CONTROL_BLOCK 32
+#endif
+
 // Q1.15 helpers
 static inline int16_t qmul_q15(int16_t a, int16_t b){
     int32_t t=(int32_t)a*(int32_t)b;
@@ -19,10 +24,6 @@ static inline int16_t sat16(int32_t x){
     if(x<-32768) return -32768;
     return (int16_t)x;
 }
-static inline int16_t lut8_to_q15(uint8_t s){
-    return ((int16_t)s-128)<<7;
-}
-
 // Detune ratio lookup table (Q16.16 fixed point)
 // Maps detune parameter (0-127, center 64) to frequency multiplier
 // Formula: 2^((tune-64)/4.0/12) gives ±16 semitone range
@@ -46,274 +47,6 @@ static const uint32_t DETUNE_RATIO_LUT[128] = {
     0x23EB3, 0x2470F, 0x24F8A, 0x25825, 0x260E0, 0x269BB, 0x272B7, 0x27BD5   // 120-127: +14.00 to +15.75 semitones
 };
 
-// Wave types - 16 matching original Rockit manual
-typedef enum {
-    W_SINE=0, W_SQUARE=1, W_SAW=2, W_TRI=3,
-    W_MORPH1=4, W_MORPH2=5, W_MORPH3=6, W_MORPH4=7,
-    W_MORPH5=8, W_MORPH6=9, W_MORPH7=10, W_MORPH8=11,
-    W_MORPH9=12, W_HARDSYNC=13, W_NOISE=14, W_RAW_SQUARE=15
-} wave_t;
-
-// Envelope states
-typedef enum { ENV_IDLE=0, ENV_ATTACK, ENV_DECAY, ENV_SUSTAIN, ENV_RELEASE } env_t;
-
-// Per-voice morph state for time-varying waveforms (matches original Rockit)
-typedef struct {
-    uint8_t morph_timer;        // Sample counter for morph speed
-    uint8_t morph_index;        // 0-255 morph position
-    uint16_t morph_index_16;    // 0-65535 for longer morph cycles
-    uint8_t morph_state;        // State machine for complex morphs (MORPH_8, MORPH_4)
-    uint8_t phase_shifter;      // Phase offset for MORPH_2
-    uint8_t phase_shift_timer;  // Timer for phase shifting
-    uint16_t lfsr;              // Per-voice LFSR for noise
-} morph_state_t;
-
-// Anti-aliasing: mipmap selection based on MIDI note
-static inline uint8_t get_mipmap_index(uint8_t note, uint8_t *blend_pos) {
-    *blend_pos = note & 0x03;  // note % 4
-    return note >> 2;           // note / 4
-}
-
-// Blend between adjacent mipmaps to prevent aliasing
-static inline uint8_t blend_mipmaps(const uint8_t table[][256], uint8_t mipmap, uint8_t blend_pos, uint8_t phase_idx) {
-    uint16_t sample;
-    
-    switch(blend_pos) {
-        case 0:  // 50% current + 50% below
-            if(mipmap == 0) return table[0][phase_idx];
-            sample = table[mipmap][phase_idx] + table[mipmap-1][phase_idx];
-            return sample >> 1;
-        case 1:  // 75% current + 25% below
-            if(mipmap == 0) return table[0][phase_idx];
-            sample = (table[mipmap][phase_idx] * 3) + table[mipmap-1][phase_idx];
-            return sample >> 2;
-        case 2:  // 75% current + 25% above
-            if(mipmap >= 31) return table[31][phase_idx];
-            sample = (table[mipmap][phase_idx] * 3) + table[mipmap+1][phase_idx];
-            return sample >> 2;
-        case 3:  // 50% current + 50% above
-            if(mipmap >= 31) return table[31][phase_idx];
-            sample = table[mipmap][phase_idx] + table[mipmap+1][phase_idx];
-            return sample >> 1;
-    }
-    return table[mipmap][phase_idx];
-}
-
-// Wavetable sampling with TIME-VARYING MORPHING (matches original Rockit firmware)
-// morph: pointer to per-voice morph state (updated each sample for time-varying behavior)
-// env_state: current envelope state for MORPH_9
-static inline int16_t wavetable_sample(uint32_t phase, wave_t w, uint8_t midi_note, morph_state_t *morph, env_t env_state){
-    uint8_t blend_pos;
-    uint8_t mipmap = get_mipmap_index(midi_note, &blend_pos);
-    uint8_t i = (uint8_t)(phase >> 24);
-    uint8_t sample_u8;
-    uint16_t temp16;
-    int16_t stemp;
-
-    if(mipmap > 31) mipmap = 31;
-
-    switch(w){
-        case W_SINE:
-            sample_u8 = G_AUC_SIN_LUT[i];
-            break;
-
-        case W_SQUARE:
-            sample_u8 = blend_mipmaps(G_AUC_SQUARE_WAVETABLE_LUT, mipmap, blend_pos, i);
-            break;
-
-        case W_SAW:
-            sample_u8 = blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i);
-            break;
-
-        case W_TRI:
-            sample_u8 = blend_mipmaps(G_AUC_TRIANGLE_WAVETABLE_LUT, mipmap, blend_pos, i);
-            break;
-
-        case W_MORPH1:  // Square morphing with inverted ramp (offset 180°)
-            if(morph->morph_timer == 0) {
-                morph->morph_index++;
-                morph->morph_timer = 15;  // MORPH_1_TIME_PERIOD
-            }
-            morph->morph_timer--;
-
-            temp16 = blend_mipmaps(G_AUC_SQUARE_WAVETABLE_LUT, mipmap, blend_pos, i) * morph->morph_index;
-            temp16 += blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i + 127)) * (255 - morph->morph_index);
-            sample_u8 = temp16 >> 8;
-            break;
-
-        case W_MORPH2:  // Triangle with phase-shifting ramp
-            if(morph->morph_timer == 0) {
-                morph->morph_index++;
-                morph->morph_timer = 10;  // MORPH_2_TIME_PERIOD
-            }
-            morph->morph_timer--;
-
-            if(morph->phase_shift_timer == 0) {
-                morph->phase_shifter++;
-                morph->phase_shift_timer = 50;  // PHASE_SHIFT_TIMER_2
-            }
-            morph->phase_shift_timer--;
-
-            temp16 = blend_mipmaps(G_AUC_TRIANGLE_WAVETABLE_LUT, mipmap, blend_pos, i) * morph->morph_index;
-            temp16 += blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i + morph->phase_shifter)) * (255 - morph->morph_index);
-            sample_u8 = temp16 >> 8;
-            break;
-
-        case W_MORPH3:  // Triangle minus reversed square (phase difference)
-            if(morph->morph_timer == 0) {
-                morph->morph_index++;
-                morph->morph_timer = 50;
-            }
-            morph->morph_timer--;
-
-            stemp = (int16_t)blend_mipmaps(G_AUC_TRIANGLE_WAVETABLE_LUT, mipmap, blend_pos, i) -
-                    (int16_t)blend_mipmaps(G_AUC_SQUARE_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i - morph->morph_index));
-            sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
-            break;
-
-        case W_MORPH4:  // Sawtooth minus reversed sawtooth (bidirectional morph)
-            if(morph->morph_timer == 0) {
-                if(morph->morph_state == 0) {
-                    morph->morph_index++;
-                    if(morph->morph_index == 255) morph->morph_state = 1;
-                } else {
-                    morph->morph_index--;
-                    if(morph->morph_index == 0) morph->morph_state = 0;
-                }
-                morph->morph_timer = 250;
-            }
-            morph->morph_timer--;
-
-            stemp = (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i) -
-                    (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i - morph->morph_index));
-            sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
-            break;
-
-        case W_MORPH5:  // Enveloped sine followed by enveloped square
-        case W_MORPH6:  // Enveloped ramp followed by enveloped square
-            if(morph->morph_timer == 0) {
-                morph->morph_index_16++;
-                morph->morph_timer = (w == W_MORPH5) ? 10 : 50;
-            }
-            morph->morph_timer--;
-
-            if(morph->morph_index_16 == 383) morph->morph_index_16 = 0;
-
-            temp16 = 0;
-            if(morph->morph_index_16 < 255) {
-                uint8_t base = (w == W_MORPH5) ? G_AUC_SIN_LUT[i] : blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i);
-                temp16 = (base * blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, morph->morph_index_16 & 0xFF)) >> 8;
-            }
-            if(morph->morph_index_16 > 128 && morph->morph_index_16 < 383) {
-                uint8_t idx = morph->morph_index_16 - 128;
-                temp16 += (blend_mipmaps(G_AUC_SQUARE_WAVETABLE_LUT, mipmap, blend_pos, i) * (255 - G_AUC_SIN_LUT[idx])) >> 8;
-            }
-            sample_u8 = (temp16 >> 1) & 0xFF;
-            break;
-
-        case W_MORPH7:  // Variable pulse width square (PWM)
-            if(morph->morph_timer == 0) {
-                morph->morph_index++;
-                morph->morph_timer = 25;
-            }
-            morph->morph_timer--;
-
-            stemp = (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i) -
-                    (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i - morph->morph_index));
-            sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
-            break;
-
-        case W_MORPH8:  // Triangle→Noise→Narrowing pulse sequence
-            if(morph->morph_timer == 0) {
-                morph->morph_index++;
-                morph->morph_timer = 5;
-            }
-            morph->morph_timer--;
-
-            switch(morph->morph_state) {
-                case 0:  // Triangle for ~20ms
-                    sample_u8 = blend_mipmaps(G_AUC_TRIANGLE_WAVETABLE_LUT, mipmap, blend_pos, i);
-                    if(morph->morph_index == 255) morph->morph_state = 1;
-                    break;
-                case 1:  // Noise for ~20ms
-                    if((i & 0x0F) == 0) {
-                        uint16_t bit = ((morph->lfsr >> 15) ^ (morph->lfsr >> 13) ^ (morph->lfsr >> 12) ^ (morph->lfsr >> 10)) & 1;
-                        morph->lfsr = (morph->lfsr << 1) | bit;
-                    }
-                    sample_u8 = morph->lfsr & 0xFF;
-                    if(morph->morph_index == 255) morph->morph_state = 2;
-                    break;
-                case 2:  // Narrowing pulse
-                case 3:  // Hold narrow pulse
-                    stemp = (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i) -
-                            (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i - morph->morph_index));
-                    sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
-                    if(morph->morph_state == 2 && morph->morph_index == 255) morph->morph_state = 3;
-                    break;
-                default:
-                    sample_u8 = 128;
-            }
-            break;
-
-        case W_MORPH9:  // Envelope-following waveform
-            switch(env_state) {
-                case ENV_ATTACK:
-                    sample_u8 = blend_mipmaps(G_AUC_TRIANGLE_WAVETABLE_LUT, mipmap, blend_pos, i);
-                    break;
-                case ENV_DECAY:
-                case ENV_SUSTAIN:
-                    stemp = (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i) -
-                            (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i - 127));
-                    sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
-                    break;
-                default:  // Release
-                    if(morph->morph_timer == 0) {
-                        morph->morph_index++;
-                        morph->morph_timer = 10;
-                    }
-                    morph->morph_timer--;
-                    stemp = (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, i) -
-                            (int16_t)blend_mipmaps(G_AUC_RAMP_WAVETABLE_LUT, mipmap, blend_pos, (uint8_t)(i - morph->morph_index));
-                    sample_u8 = (stemp > 127) ? 255 : ((stemp < -128) ? 0 : (128 + stemp));
-            }
-            break;
-
-        case W_HARDSYNC:  // Hard sync (uses 128-sample table, no blending)
-            // Hardsync table has 16 mipmaps with 128 samples each
-            // Use half the mipmap levels and half the phase resolution
-            {
-                uint8_t hs_mipmap = (mipmap >> 1) & 0x0F;  // Clamp to 0-15
-                uint8_t hs_phase = i >> 1;                  // 0-127 index
-                sample_u8 = G_AUC_HARDSYNC_2_WAVETABLE_LUT[hs_mipmap][hs_phase];
-            }
-            break;
-
-        case W_NOISE:  // LFSR-based pseudo-random noise
-            if((i & 0x0F) == 0) {
-                uint16_t bit = ((morph->lfsr >> 15) ^ (morph->lfsr >> 13) ^ (morph->lfsr >> 12) ^ (morph->lfsr >> 10)) & 1;
-                morph->lfsr = (morph->lfsr << 1) | bit;
-            }
-            sample_u8 = morph->lfsr & 0xFF;
-            break;
-
-        case W_RAW_SQUARE:  // Raw aliasing square
-            sample_u8 = (i < 128) ? 255 : 0;
-            break;
-
-        default:
-            sample_u8 = G_AUC_SIN_LUT[i];
-            break;
-    }
-
-    return ((int16_t)sample_u8 - 128) << 7;
-}
-
-// LFO structure
-typedef struct{ 
-    uint32_t ph, inc; 
-    uint8_t shape; 
-    int16_t depth_q; 
-} lfo_t;
 
 static inline uint32_t hz_to_inc(float hz, int sr){ 
     double k=(hz*4294967296.0)/(double)sr; 
@@ -322,69 +55,6 @@ static inline uint32_t hz_to_inc(float hz, int sr){
     return (uint32_t)k; 
 }
 
-// LFO waveform generation - 16 shapes
-static inline int16_t lfo_wave(uint32_t ph, uint8_t shape){
-    uint8_t i=(uint8_t)(ph>>24);
-    static uint16_t lfsr = 0xACE1;
-    
-    switch(shape){
-        case 0:  // Sine
-            return lut8_to_q15(G_AUC_SIN_LUT[i]);
-        case 1:  // Square
-            return (i<128)?32767:-32768;
-        case 2:  // Ramp/Saw
-            return lut8_to_q15(i);
-        case 3:  // Triangle
-            return lut8_to_q15((i<128)?(i<<1):(255-((i-128)<<1)));
-        case 4:
-        case 5:
-        case 6:
-            return lut8_to_q15(G_AUC_TRIANGLE_SIMPLE_WAVETABLE_LUT[i]);
-        case 7:
-        case 8:
-        case 9:
-            return lut8_to_q15(G_AUC_SQUARE_SIMPLE_WAVETABLE_LUT[i]);
-        case 10: // Reverse ramp
-            return lut8_to_q15(255-i);
-        case 11:
-        case 12:
-            return lut8_to_q15(G_AUC_RAMP_SIMPLE_WAVETABLE_LUT[i]);
-        case 13: // Hard sync
-            return lut8_to_q15(G_AUC_HARDSYNC_2_SIMPLE_WAVETABLE_LUT[i>>1]);
-        case 14: // Noise (LFSR)
-            if((i & 0x0F) == 0) {
-                uint16_t bit = ((lfsr >> 15) ^ (lfsr >> 13) ^ (lfsr >> 12) ^ (lfsr >> 10)) & 1;
-                lfsr = (lfsr << 1) | bit;
-            }
-            return (int16_t)(lfsr & 0xFFFF) - 16384;
-        case 15: // Raw square
-            return (i<128)?32767:-32768;
-        default:
-            return lut8_to_q15(G_AUC_SIN_LUT[i]);
-    }
-}
-
-typedef struct {
-    uint8_t active;
-    uint8_t note;
-    uint32_t ph1, inc1, ph2, inc2;
-    env_t env;
-    int16_t env_q;
-    uint32_t t, atk, dec, rel;
-    int16_t sus_q;
-    uint32_t inc_target, inc_cur;
-    morph_state_t morph1, morph2;  // Separate morph state for OSC1 and OSC2
-} voice_state_t;
-
-static voice_state_t V[3];
-static lfo_t L1, L2;  // Two LFOs!
-static svf_t flt;
-static int g_sr = 48000;
-
-// Track tuning params to avoid expensive recalculation every sample
-static int16_t g_last_tune = -999;
-static uint8_t g_tuning_dirty = 1;
-
 // Arpeggiator patterns (from original Rockit firmware)
 // 16 patterns × 8 steps, values are semitone offsets from base note
 static const int8_t ARP_PATTERNS[16][8] = {
@@ -406,11 +76,6 @@ static const int8_t ARP_PATTERNS[16][8] = {
     {0,3,7,11,7,3,0,11}             // 15: Minor 7 palindrome
 };
 
-// Arpeggiator state
-static uint8_t arp_step = 0;        // Current step in pattern (0-7)
-static uint32_t arp_counter = 0;    // Sample counter for timing
-static uint8_t arp_note_on = 0;     // Current note state (for gate)
-
 static const uint16_t FREQ[128]={
  8,9,9,10,10,11,12,12,13,14,15,15,16,17,18,19,21,22,23,24,26,28,29,31,33,35,37,39,41,44,46,49,52,55,58,62,
  65,69,73,78,82,87,92,98,104,110,117,123,131,139,147,156,165,175,185,196,208,220,233,247,262,277,294,311,
@@ -423,10 +88,6 @@ static inline float semi(int st){
     return powf(2.0f, st/12.0f);
 }
 
-static inline uint32_t ms_to_samples(float ms, int sr){
-    return (uint32_t)((ms*0.001f)*(float)sr);
-}
-
 // Calculate phase increment with detune matching original Rockit firmware
 // tune_param: 0-127, center at 64, ±16 semitones range (matches original OSC_DETUNE)
 static inline uint32_t calc_phase_inc(uint8_t note, int tune_param, int sr) {
@@ -445,19 +106,24 @@ static inline uint32_t calc_phase_inc(uint8_t note, int tune_param, int sr) {
     return hz_to_inc(hz, sr);
 }
 
-static void voice_trigger(voice_state_t *v, uint8_t note, int sr){
-    v->active = 1;
+static void voice_trigger(rockit_engine_t *e, int idx, uint8_t note){
+    voice_state_t *v = &e->voice[idx];
+    voice_hot_t *h = &e->hot[idx];
+    int sr = e->sr;
+    h->active = 1;
     v->note = note;
+    osc_tables_bind(&v->tabs, &e->osc_cache, note);
     // Don't reset phase to avoid clicks - let it continue
-    // v->ph1 = 0;
-    // v->ph2 = 0;
+    // h->ph1 = 0;
+    // h->ph2 = 0;
 
     // OSC1: Base tuning (no detune offset)
     v->inc1 = calc_phase_inc(note, 0, sr);
+    h->inc1 = v->inc1;  // Pitch LFO is re-applied at the next control block
 
     // OSC2: Set base frequency for glide target
-    // Detune is applied in voice_tick() AFTER glide (matching original Rockit)
-    uint8_t sub_osc_mode = params_get(P_SUBOSC);
+    // Detune is applied in voice_render() AFTER glide (matching original Rockit)
+    uint8_t sub_osc_mode = params_get(&e->params, P_SUBOSC);
     if(sub_osc_mode) {
         // Sub-osc mode: base frequency one octave below
         uint8_t sub_note = (note >= 12) ? (note - 12) : 0;
@@ -468,26 +134,22 @@ static void voice_trigger(voice_state_t *v, uint8_t note, int sr){
     }
 
     // Glide/Portamento: If glide is OFF, jump immediately. If ON, glide from current to target.
-    int glide_param = params_get(P_GLIDE_TIME);
+    int glide_param = params_get(&e->params, P_GLIDE_TIME);
     if(glide_param == 0) {
         // No glide - jump immediately to new frequency
         v->inc_cur = v->inc_target;
-        // Note: detune will be applied in voice_tick()
+        // Note: detune will be applied in voice_render()
     }
-    // else: keep inc_cur at previous value, glide will interpolate in voice_tick
-
-    v->env = ENV_ATTACK;
-    v->env_q = 0;
-    v->t = 0;
+    // else: keep inc_cur at previous value, glide will interpolate in voice_render
 
-    float a_ms = ((float)params_get(P_ENV_ATTACK)/127.0f)*2000.0f;
-    float d_ms = ((float)params_get(P_ENV_DECAY)/127.0f)*2000.0f;
-    float r_ms = ((float)params_get(P_ENV_RELEASE)/127.0f)*2000.0f;
+    // Attack rises from the current level (like amp_adsr.c): a retriggered
+    // voice does not click back to zero
+    h->env = ENV_ATTACK;
 
-    v->atk = ms_to_samples(a_ms, sr);
-    v->dec = ms_to_samples(d_ms, sr);
-    v->rel = ms_to_samples(r_ms, sr);
-    v->sus_q = ((int16_t)params_get(P_ENV_SUSTAIN)*32767)/127;
+    v->eg.atk = e->env_tab.rate[params_get(&e->params, P_ENV_ATTACK) & 0x7F];
+    v->eg.dec = e->env_tab.rate[params_get(&e->params, P_ENV_DECAY) & 0x7F];
+    v->eg.rel = e->env_tab.rate[params_get(&e->params, P_ENV_RELEASE) & 0x7F];
+    v->eg.sus = env_sustain_level(params_get(&e->params, P_ENV_SUSTAIN));
 
     // Initialize morph state for time-varying waveforms
     // Seed LFSR with unique value per voice (avoid all voices having same noise)
@@ -496,208 +158,405 @@ static void voice_trigger(voice_state_t *v, uint8_t note, int sr){
     // Don't reset other morph state - let it continue for smooth morphing across notes
 }
 
-static void voice_release(voice_state_t *v){
-    if(v->env == ENV_IDLE) return;
-    v->env = ENV_RELEASE;
-    v->t = 0;
+static void voice_release(voice_hot_t *h){
+    if(h->env == ENV_IDLE) return;
+    h->env = ENV_RELEASE;  // Falls from the current level
 }
 
-static int16_t voice_tick(voice_state_t *v, int sr, int tune, int mix){
-    if(!v->active) return 0;
-
-    // OSC1: Always at base tuning (no detune)
-    // Keep inc1 as set in voice_trigger
-
+// Per-block voice settings, resolved once per control block for all voices
+typedef struct {
+    osc_engine_t engine;    // Oscillator engine
+    uint32_t width;         // Pulse width phase (square/raw square)
+    wave_t w1, w2;          // Oscillator waveforms
+    uint32_t glide_rate;    // Glide time constant in samples (0 = glide off)
+    int tune;               // Detune (0-127, 64 = none) after LFO modulation
+    int32_t mix_q;          // OSC2 weight in Q15 at block start (0 = all OSC1)
+    int32_t mix_step;       // Per-sample mix ramp
+} voice_block_t;
+
+// Render n samples of one voice into dst (Q15 in int32).
+// Glide, detune and waveform dispatch happen once per block; the per-sample
+// loop only mixes the two oscillator buffers and runs the envelope.
+static void voice_render(voice_state_t *v, voice_hot_t *h, int32_t *dst, size_t n, const voice_block_t *b){
     // OSC2 Architecture (matching original Rockit):
     // 1. BASE frequency (inc_target) is set in voice_trigger() and remains stable
-    // 2. Apply glide to BASE frequency (inc_target -> inc_cur -> inc2)
+    // 2. Apply glide to BASE frequency (inc_target -> inc_cur)
     // 3. Then apply detune (including LFO modulation) as frequency multiplier
 
-    // NOTE: inc_target is pre-calculated in voice_trigger() - DO NOT recalculate here!
-    // Recalculating every sample causes severe performance issues (144k calls/sec)
-
-    // Apply glide to base frequency (uses pre-calculated inc_target from voice_trigger)
-    float glide = (float)params_get(P_GLIDE_TIME)/127.0f;
-    if(glide > 0.01f){
-        uint32_t glide_rate = (uint32_t)(glide * 100.0f * (float)sr / 1000.0f);
-        if(glide_rate < 1) glide_rate = 1;
-
-        if(v->inc_cur < v->inc_target){
-            uint32_t delta = (v->inc_target - v->inc_cur) / glide_rate;
-            if(delta < 1) delta = 1;
-            v->inc_cur += delta;
-            if(v->inc_cur > v->inc_target) v->inc_cur = v->inc_target;
-        } else if(v->inc_cur > v->inc_target){
-            uint32_t delta = (v->inc_cur - v->inc_target) / glide_rate;
-            if(delta < 1) delta = 1;
-            v->inc_cur -= delta;
-            if(v->inc_cur < v->inc_target) v->inc_cur = v->inc_target;
-        }
-        v->inc2 = v->inc_cur;
+    // Glide: advance the base frequency by a whole block at once
+    if(b->glide_rate > 0 && v->inc_cur != v->inc_target){
+        uint32_t diff = (v->inc_cur < v->inc_target) ? v->inc_target - v->inc_cur : v->inc_cur - v->inc_target;
+        uint64_t delta = ((uint64_t)diff * n) / b->glide_rate;
+        if(delta < n) delta = n;        // At least 1 per sample, like the per-sample glide
+        if(delta > diff) delta = diff;
+        if(v->inc_cur < v->inc_target) v->inc_cur += (uint32_t)delta;
+        else v->inc_cur -= (uint32_t)delta;
     } else {
-        v->inc2 = v->inc_target;
+        v->inc_cur = v->inc_target;
+    }
+    h->inc2 = v->inc_cur;
+
+    // Detune only applies to OSC2 in normal mode (not sub-osc mode):
+    // inc_target == inc1 means normal mode. Fixed-point ratio from the LUT
+    // avoids powf() (no FPU on MT7688).
+    if(v->inc_target == v->inc1 && b->tune != 64) {
+        uint32_t ratio = DETUNE_RATIO_LUT[b->tune & 0x7F];
+        h->inc2 = (uint32_t)(((uint64_t)h->inc2 * ratio) >> 16);
     }
 
-    // Now apply detune/vibrato AFTER glide (matches original Rockit architecture)
-    // Detune only applies to OSC2 in normal mode (not sub-osc mode)
-    // Sub-osc mode is determined at voice_trigger() time via inc_target
-    // Check if this voice has detune enabled by comparing inc_target to inc1
-    if(v->inc_target == v->inc1) {
-        // inc_target == inc1 means normal mode (not sub-osc)
-        // Apply detune as frequency multiplier using FIXED-POINT lookup table
-        // This avoids expensive powf() calls (no FPU on MT7688, emulated in software)
-        if(tune != 64) {
-            // Fast fixed-point multiply using lookup table (Q16.16 format)
-            // DETUNE_RATIO_LUT maps tune value (0-127) to frequency multiplier
-            // Uses 64-bit intermediate to prevent overflow, then shifts for Q16.16
-            uint32_t ratio = DETUNE_RATIO_LUT[tune & 0x7F];  // Clamp to valid range
-            v->inc2 = (uint32_t)(((uint64_t)v->inc2 * ratio) >> 16);
+    // Oscillators: one waveform dispatch per block each
+    int16_t s1[ROCKIT_CONTROL_BLOCK], s2[ROCKIT_CONTROL_BLOCK];
+    osc_render_block(s1, n, &h->ph1, h->inc1, b->engine, b->width, b->w1, &v->tabs, &v->morph1, (env_t)h->env);
+    osc_render_block(s2, n, &h->ph2, h->inc2, b->engine, b->width, b->w2, &v->tabs, &v->morph2, (env_t)h->env);
+
+    int32_t mix_q = b->mix_q;
+    int32_t lvl = h->env_lvl;
+    for(size_t i=0; i<n; i++){
+        // Use modulated mix (can be modulated by LFO2, ramped per sample)
+        int32_t osc = ((32767-mix_q)*s1[i] + mix_q*s2[i]) >> 15;
+        mix_q += b->mix_step;
+
+        // Envelope: one add and compare per sample
+        lvl = env_step(lvl, &h->env, &v->eg);
+
+        dst[i] = qmul_q15((int16_t)osc, (int16_t)(lvl >> ENV_SHIFT));
+
+        if(h->env == ENV_IDLE){
+            // Voice finished mid-block: silence the rest
+            h->active = 0;
+            for(i++; i<n; i++) dst[i] = 0;
+            break;
         }
     }
-    // else: sub-osc mode (inc_target != inc1), detune is ignored
-    
-    // Oscillators with anti-aliasing and TIME-VARYING MORPHING
-    wave_t w1 = (wave_t)params_get(P_OSC1_WAVE);
-    wave_t w2 = (wave_t)params_get(P_OSC2_WAVE);
-    if(w1 > 15) w1 = W_SINE;
-    if(w2 > 15) w2 = W_SINE;
+    h->env_lvl = lvl;
+    h->env_q = (int16_t)(lvl >> ENV_SHIFT);
+}
 
-    // Pass morph state pointers for time-varying waveforms, and envelope state for MORPH_9
-    int16_t s1 = wavetable_sample(v->ph1, w1, v->note, &v->morph1, v->env);
-    int16_t s2 = wavetable_sample(v->ph2, w2, v->note, &v->morph2, v->env);
+// Arpeggiator step/gate timing for the current render call
+typedef struct {
+    uint8_t base_note;      // Base note from attack knob
+    uint8_t pattern;        // 0-15
+    uint8_t length;         // Steps in pattern (1-8)
+    uint32_t step_length;   // Samples per step
+    uint32_t gate_length;   // Samples the note stays on within a step
+} arp_cfg_t;
+
+// Advance the arpeggiator by one sample and fire any gate/step events.
+// Returns how many samples (>= 1) can be rendered before the next event,
+// so voice blocks can be split exactly at arpeggiator note boundaries.
+static uint32_t arp_tick(rockit_engine_t *e, const arp_cfg_t *a){
+    e->arp_counter++;
+
+    // Gate off time
+    if(e->arp_note_on && e->arp_counter >= a->gate_length) {
+        rockit_note_off(e, a->base_note + ARP_PATTERNS[a->pattern][e->arp_step]);
+        e->arp_note_on = 0;
+    }
 
-    // Use modulated mix (can be modulated by LFO2)
-    int32_t osc = ((127-mix)*s1 + mix*s2) / 127;
+    // Advance to next step
+    if(e->arp_counter >= a->step_length) {
+        // Move to next step
+        e->arp_step++;
+        if(e->arp_step >= a->length) {
+            e->arp_step = 0;
+        }
 
-    v->ph1 += v->inc1;
-    v->ph2 += v->inc2;
-    
-    // Envelope
-    switch(v->env){
-        case ENV_ATTACK:
-            if(v->atk == 0){
-                v->env_q = 32767;
-                v->env = ENV_DECAY;
-                v->t = 0;
-            } else {
-                v->env_q = (int16_t)((32767UL * v->t) / v->atk);
-                v->t++;
-                if(v->t >= v->atk){
-                    v->env = ENV_DECAY;
-                    v->t = 0;
-                }
-            }
-            break;
-        case ENV_DECAY:
-            if(v->dec == 0){
-                v->env_q = v->sus_q;
-                v->env = ENV_SUSTAIN;
-            } else {
-                int16_t delta = 32767 - v->sus_q;
-                v->env_q = 32767 - (int16_t)((delta * v->t) / v->dec);
-                v->t++;
-                if(v->t >= v->dec){
-                    v->env = ENV_SUSTAIN;
+        // Calculate note with pattern offset (clamped to MIDI range)
+        int16_t note_with_offset = a->base_note + ARP_PATTERNS[a->pattern][e->arp_step];
+        if(note_with_offset < 0) note_with_offset = 0;
+        if(note_with_offset > 127) note_with_offset = 127;
+
+        // Trigger note
+        rockit_note_on(e, (uint8_t)note_with_offset);
+        e->arp_note_on = 1;
+        e->arp_counter = 0;
+    }
+
+    uint32_t next = a->step_length - e->arp_counter;
+    if(e->arp_note_on && e->arp_counter < a->gate_length && a->gate_length - e->arp_counter < next)
+        next = a->gate_length - e->arp_counter;
+    return next;
+}
+
+// ==== CONTROL-RATE MODULATION ====
+// LFOs and modulation routing are evaluated once every ROCKIT_CONTROL_BLOCK
+// samples instead of per sample. Audio-rate targets (volume, osc mix) are
+// ramped linearly across the block, and the SVF coefficients are recomputed
+// once per block - the only affordable way to get filter sweeps on the
+// soft-float MT7688. Override with -DROCKIT_CONTROL_BLOCK=16 etc.
+
+typedef struct {
+    int32_t vol_q, vol_step;    // Master volume (Q15) and its per-sample ramp
+    int32_t mix_q, mix_step;    // OSC2 mix weight (Q15) and its per-sample ramp
+    int tune;                   // Detune after LFO1 modulation (0-127)
+    uint32_t width;             // Pulse width phase after LFO1 modulation
+} control_t;
+
+// True if parameter id changed since the engine last consumed it
+static inline int snap_changed(rockit_engine_t *e, const params_snapshot_t *P, param_id_t id){
+    if(e->derived_valid && P->gen[id] == e->seen_gen[id]) return 0;
+    e->seen_gen[id] = P->gen[id];
+    return 1;
+}
+
+static inline int clamp127(int x){
+    if(x < 0) return 0;
+    if(x > 127) return 127;
+    return x;
+}
+
+// Evaluate LFOs and modulation routing for the next n samples
+static void control_update(rockit_engine_t *e, control_t *c, const params_snapshot_t *P, size_t n, int sr, int tune, uint8_t drone_mode){
+    // LFO 2 first - it can modulate LFO 1 rate and depth
+    // LFO2 destinations: 0:Mix, 1:Filter, 2:FilterQ, 3:LFO1Rate, 4:LFO1Depth, 5:FilterAtk
+    int lfo2_dest = P->v[P_LFO2_DEST];
+    int16_t lfo2_mod = lfo_mod(&e->lfo2, P->v[P_LFO2_DEPTH]);
+
+    int lfo1_rate = P->v[P_LFO1_RATE];
+    int lfo1_depth = P->v[P_LFO1_DEPTH];
+    if(lfo2_dest == 3) lfo1_rate = clamp127(lfo1_rate + lfo2_mod);
+    if(lfo2_dest == 4) lfo1_depth = clamp127(lfo1_depth + lfo2_mod);
+    if(lfo1_rate != e->lfo1_rate){
+        e->lfo1.inc = hz_to_inc(0.01f + ((float)lfo1_rate/127.0f)*20.0f, sr);
+        e->lfo1_rate = lfo1_rate;
+    }
+
+    // LFO1 destinations: 0:Amp, 1:Filter, 2:FilterQ, 3:FilterEnv, 4:Pitch, 5:Detune, 6:PulseWidth
+    int lfo1_dest = P->v[P_LFO1_DEST];
+    int16_t lfo1_mod = lfo_mod(&e->lfo1, lfo1_depth);
+
+    int vol = P->v[P_MASTER_VOL];
+    int mix = P->v[P_OSC_MIX];
+    int32_t cutoff_q8 = (int32_t)P->v[P_FILTER_CUTOFF] * 256;
+    int res = P->v[P_FILTER_RESONANCE];
+    int env_amt = P->v[P_FILTER_ENV_AMT] - 64;  // Bipolar, 0 at 12 o'clock
+    int pw = P->v[P_PULSE_WIDTH];
+    uint32_t pitch_ratio = 0x10000;                    // Q16.16, unity
+
+    switch(lfo1_dest) {
+        case 0: vol += lfo1_mod; break;                                   // Amplitude
+        case 1: cutoff_q8 += (int32_t)lfo1_mod * 256; break;              // Filter Cutoff
+        case 2: res += lfo1_mod; break;                                   // Filter Q
+        case 3: env_amt += lfo1_mod; break;                               // Filter Env Amount
+        case 4: pitch_ratio = DETUNE_RATIO_LUT[clamp127(64 + lfo1_mod)]; break;  // OSC1 Pitch (±16 st)
+        case 5: tune += lfo1_mod; break;                                  // Detune
+        case 6: pw += lfo1_mod; break;                                    // Pulse Width (PWM)
+    }
+
+    switch(lfo2_dest) {
+        case 0: mix += lfo2_mod; break;                                   // OSC Mix
+        case 1: cutoff_q8 += (int32_t)lfo2_mod * 256; break;              // Filter Cutoff
+        case 2: res += lfo2_mod; break;                                   // Filter Q
+        case 3: break;  // LFO1 Rate - applied above
+        case 4: break;  // LFO1 Depth - applied above
+        case 5: break;  // Filter Attack - no separate filter envelope in this port
+    }
+
+    // Filter envelope: follows the loudest voice's amplitude envelope
+    // (drone mode has no envelope, matching the original drone loop)
+    if(!drone_mode && env_amt != 0) {
+        int16_t env_q = 0;
+        for(int v=0; v<3; v++){
+            if(e->hot[v].active && e->hot[v].env_q > env_q) env_q = e->hot[v].env_q;
+        }
+        if(env_amt > 64) env_amt = 64;
+        if(env_amt < -64) env_amt = -64;
+        cutoff_q8 += (env_amt * 2 * (int32_t)env_q) >> 7;  // ±128 param units at full scale
+    }
+
+    // Filter coefficients: once per control block, only when the target moved
+    if(cutoff_q8 < 0) cutoff_q8 = 0;
+    if(cutoff_q8 > 127 * 256) cutoff_q8 = 127 * 256;
+    // Exponential 20Hz-20kHz scaling like original Rockit, via the SVF's
+    // per-sample-rate coefficient tables (no tanf/powf here)
+    if(cutoff_q8 != e->cutoff_q8) {
+        svf_set_cutoff_param(&e->flt, cutoff_q8);
+        e->cutoff_q8 = cutoff_q8;
+    }
+    res = clamp127(res);
+    if(res != e->res) {
+        svf_set_res_param(&e->flt, res << 8);
+        e->res = res;
+    }
+
+    // OSC1 pitch modulation
+    for(int v=0; v<3; v++){
+        if(!e->hot[v].active) continue;
+        e->hot[v].inc1 = (pitch_ratio == 0x10000) ? e->voice[v].inc1 :
+                     (uint32_t)(((uint64_t)e->voice[v].inc1 * pitch_ratio) >> 16);
+    }
+
+    c->tune = clamp127(tune);
+    c->width = osc_pulse_width(pw);
+
+    // Per-sample ramps towards this block's targets
+    // Exponential curve on volume (LFO tremolo affects volume curve)
+    vol = clamp127(vol);
+    int32_t vol_target = (int32_t)vol * vol * 32767 / (127 * 127);
+    int32_t mix_target = (int32_t)clamp127(mix) * 32767 / 127;
+    if(e->vol_q < 0) e->vol_q = vol_target;
+    if(e->mix_q < 0) e->mix_q = mix_target;
+    c->vol_q = e->vol_q;
+    c->vol_step = (vol_target - e->vol_q) / (int32_t)n;
+    c->mix_q = e->mix_q;
+    c->mix_step = (mix_target - e->mix_q) / (int32_t)n;
+    e->vol_q += c->vol_step * (int32_t)n;
+    e->mix_q += c->mix_step * (int32_t)n;
+
+    // Advance LFO phase accumulators by the whole block
+    e->lfo1.ph += e->lfo1.inc * (uint32_t)n;
+    e->lfo2.ph += e->lfo2.inc * (uint32_t)n;
+}
+
+// ============================================================================
+// MIDI EVENT QUEUES
+// ============================================================================
+// Input threads never touch engine state: they push timestamped events into
+// their own SPSC queue (midi_queue.h) and the audio thread applies them here.
+// A render call covers the wall-clock time since the previous call started,
+// one period late: an event stamped dt after the previous render started is
+// applied dt into this period. That fixed one-period latency replaces up to a
+// full period of jitter with one sample.
+
+int rockit_engine_attach_queue(rockit_engine_t *e, midi_queue_t *q){
+    if(e->queue_count >= ROCKIT_MAX_QUEUES) return -1;
+    e->queues[e->queue_count++] = q;
+    return 0;
+}
+
+// Drain all queues into e->events[], sorted by sample offset
+static void events_collect(rockit_engine_t *e, size_t frames, int sr){
+    uint64_t now = midi_clock_ns();
+    uint64_t prev = e->prev_render_ns;
+    uint32_t last = frames ? (uint32_t)frames - 1 : 0;
+    e->prev_render_ns = now;
+    e->event_count = 0;
+    e->event_next = 0;
+
+    for(int qi=0; qi<e->queue_count; qi++){
+        const midi_event_t *ev;
+        while(e->event_count < ROCKIT_MAX_EVENTS && (ev = midi_queue_peek(e->queues[qi])) != NULL){
+            if(ev->t_ns > now) break;  // Pushed while draining: belongs to the next period
+
+            uint32_t off = 0;
+            if(prev && ev->t_ns > prev){
+                uint64_t dt = ev->t_ns - prev;
+                off = last;
+                if(dt < 1000000000ull){
+                    uint64_t o = dt * (uint64_t)sr / 1000000000ull;
+                    if(o < last) off = (uint32_t)o;
                 }
             }
-            break;
-        case ENV_SUSTAIN:
-            v->env_q = v->sus_q;
-            break;
-        case ENV_RELEASE:
-            if(v->rel == 0){
-                v->env_q = 0;
-                v->active = 0;
-                v->env = ENV_IDLE;
-            } else {
-                int16_t start = v->env_q;
-                v->env_q = start - (int16_t)((start * v->t) / v->rel);
-                v->t++;
-                if(v->t >= v->rel || v->env_q <= 0){
-                    v->env_q = 0;
-                    v->active = 0;
-                    v->env = ENV_IDLE;
-                }
+
+            // Insertion sort (stable, so each queue keeps its own order)
+            size_t k = e->event_count++;
+            while(k > 0 && e->events[k-1].offset > off){
+                e->events[k] = e->events[k-1];
+                k--;
             }
-            break;
-        default:
-            v->env_q = 0;
-            v->active = 0;
-            break;
+            e->events[k].offset = off;
+            e->events[k].status = ev->status;
+            e->events[k].data1 = ev->data1;
+            e->events[k].data2 = ev->data2;
+            midi_queue_pop(e->queues[qi]);
+        }
     }
-    
-    return qmul_q15((int16_t)osc, v->env_q);
+}
+
+void rockit_handle_midi(rockit_engine_t *e, uint8_t status, uint8_t data1, uint8_t data2){
+    status &= 0xF0;  // Omni: every channel plays the synth
+    if(status == 0x90 && data2 > 0){
+        rockit_note_on(e, data1);
+    } else if(status == 0x90 || status == 0x80){
+        rockit_note_off(e, data1);  // Note On with velocity 0 is a Note Off
+    } else if(status == 0xB0){
+        rockit_handle_cc(e, data1, data2);
+    }
+}
+
+// Apply every collected event due at or before sample pos; returns how many
+static int events_apply_until(rockit_engine_t *e, size_t pos){
+    int applied = 0;
+    while(e->event_next < e->event_count && e->events[e->event_next].offset <= pos){
+        const pending_event_t *ev = &e->events[e->event_next++];
+        // Patch save/recall does file I/O: receivers handle it before queuing
+        // (rockit_handle_patch_cc), the audio thread never does
+        if((ev->status & 0xF0) == 0xB0 && (ev->data1 == 92 || ev->data1 == 93)) continue;
+        rockit_handle_midi(e, ev->status, ev->data1, ev->data2);
+        applied++;
+    }
+    return applied;
 }
 
 void rockit_engine_init(rockit_engine_t *e){
-    (void)e;
+    // Voices, LFOs, arpeggiator and queue state all start from zero
+    memset(e, 0, sizeof(*e));
 
     // CRITICAL: Initialize all parameters to their default values
-    params_init();
+    params_init(&e->params);
 
-    memset(V, 0, sizeof(V));
-    memset(&L1, 0, sizeof(L1));
-    memset(&L2, 0, sizeof(L2));
+    e->lfo1.lfsr = 0xACE1;
+    e->lfo2.lfsr = 0xACE1;
 
     // Initialize filter with default sample rate
-    svf_init(&flt, 48000);
+    svf_init(&e->flt, 48000);
+    env_table_init(&e->env_tab, 48000);
+    osc_cache_init(&e->osc_cache);
+    osc_hq_init();
+    e->sr = 48000;
+
+    // Force modulation targets to be re-evaluated on the first control block
+    e->vol_q = -1;
+    e->mix_q = -1;
+    e->cutoff_q8 = -1;
+    e->res = -1;
+    e->lfo1_rate = -1;
+    e->derived_valid = 0;
 
     // Initialize paraphonic system
-    paraphonic_init();
+    paraphonic_init(&e->para);
 }
 
-void rockit_engine_render(rockit_engine_t *e, int16_t *out, size_t frames, int sr){
-    g_sr = sr;
-
-    // Check if tuning param changed (ONCE per render call, not per sample!)
-    int16_t tune = params_get(P_TUNE);
-    g_tuning_dirty = (tune != g_last_tune);
-    if(g_tuning_dirty){
-        g_last_tune = tune;
+// Settings derived from the parameter snapshot that hold until the next
+// mid-period event: tune, filter mode, drone/arpeggiator config and the
+// voice block (engine, waveforms, glide)
+typedef struct {
+    int16_t tune;
+    int filter_mode;
+    uint8_t drone_mode;
+    arp_cfg_t arp;
+} render_cfg_t;
+
+static void render_setup(rockit_engine_t *e, const params_snapshot_t *P, int sr, render_cfg_t *r, voice_block_t *vb){
+    r->tune = P->v[P_TUNE];
+
+    // LFO parameters (LFO1 rate is handled per control block - LFO2 can modulate it)
+    e->lfo1.shape = P->v[P_LFO1_SHAPE] & 0x0F;
+    e->lfo1.depth_q = ((int16_t)P->v[P_LFO1_DEPTH]*32767)/127;
+
+    if(snap_changed(e, P, P_LFO2_RATE)){
+        float lfo2_hz = 0.01f + ((float)P->v[P_LFO2_RATE]/127.0f)*20.0f;
+        e->lfo2.inc = hz_to_inc(lfo2_hz, sr);
     }
-
-    // LFO1 parameters
-    float lfo1_hz = 0.01f + ((float)params_get(P_LFO1_RATE)/127.0f)*20.0f;
-    L1.inc = hz_to_inc(lfo1_hz, sr);
-    L1.shape = params_get(P_LFO1_SHAPE) & 0x0F;
-    L1.depth_q = ((int16_t)params_get(P_LFO1_DEPTH)*32767)/127;
-
-    // LFO2 parameters
-    float lfo2_hz = 0.01f + ((float)params_get(P_LFO2_RATE)/127.0f)*20.0f;
-    L2.inc = hz_to_inc(lfo2_hz, sr);
-    L2.shape = params_get(P_LFO2_SHAPE) & 0x0F;
-    L2.depth_q = ((int16_t)params_get(P_LFO2_DEPTH)*32767)/127;
-
-    // Filter parameters - Exponential scaling like original Rockit
-    // Maps 0-127 to 20Hz-20kHz with exponential curve for musical response
-    int cutoff_param = params_get(P_FILTER_CUTOFF);
-    float cutoff_norm = cutoff_param / 127.0f;  // 0.0 to 1.0
-    float cutoff_hz = 20.0f * powf(1000.0f, cutoff_norm);  // 20Hz to 20kHz exponential
-
-    float q = 0.5f + (params_get(P_FILTER_RESONANCE)/127.0f) * 19.5f;
-    svf_set_cutoff(&flt, cutoff_hz);
-    svf_set_q(&flt, q);
+    e->lfo2.shape = P->v[P_LFO2_SHAPE] & 0x0F;
+    e->lfo2.depth_q = ((int16_t)P->v[P_LFO2_DEPTH]*32767)/127;
 
     // Get filter mode for later use in the loop
-    int filter_mode = params_get(P_FILTER_MODE);
+    r->filter_mode = P->v[P_FILTER_MODE];
 
     // LIVE ENVELOPE PARAMETER UPDATES - Read envelope params and update all active voices
     // This allows real-time parameter changes while notes are held (like real synths)
-    float a_ms = ((float)params_get(P_ENV_ATTACK)/127.0f)*2000.0f;
-    float d_ms = ((float)params_get(P_ENV_DECAY)/127.0f)*2000.0f;
-    float r_ms = ((float)params_get(P_ENV_RELEASE)/127.0f)*2000.0f;
-    uint32_t atk_samples = ms_to_samples(a_ms, sr);
-    uint32_t dec_samples = ms_to_samples(d_ms, sr);
-    uint32_t rel_samples = ms_to_samples(r_ms, sr);
-    int16_t sus_q = ((int16_t)params_get(P_ENV_SUSTAIN)*32767)/127;
+    // Slopes are looked up only when the knobs actually move (the env_tab slopes are
+    // rebuilt on a sample rate change)
+    if(snap_changed(e, P, P_ENV_ATTACK)) e->eg.atk = e->env_tab.rate[P->v[P_ENV_ATTACK] & 0x7F];
+    if(snap_changed(e, P, P_ENV_DECAY)) e->eg.dec = e->env_tab.rate[P->v[P_ENV_DECAY] & 0x7F];
+    if(snap_changed(e, P, P_ENV_RELEASE)) e->eg.rel = e->env_tab.rate[P->v[P_ENV_RELEASE] & 0x7F];
+    if(snap_changed(e, P, P_ENV_SUSTAIN)) e->eg.sus = env_sustain_level(P->v[P_ENV_SUSTAIN]);
 
     // Update envelope parameters for all active voices
     for(int v=0; v<3; v++){
-        if(V[v].active){
-            V[v].atk = atk_samples;
-            V[v].dec = dec_samples;
-            V[v].rel = rel_samples;
-            V[v].sus_q = sus_q;
+        if(e->hot[v].active){
+            e->voice[v].eg = e->eg;
         }
     }
 
@@ -707,40 +566,44 @@ void rockit_engine_render(rockit_engine_t *e, int16_t *out, size_t frames, int s
     // - ENV_DECAY knob controls arpeggiator pattern: 0-15 (16 patterns)
     // - ENV_SUSTAIN knob controls amplitude directly (bypasses envelope)
     // - ENV_RELEASE knob controls arpeggiator speed
-    static uint8_t prev_drone_mode = 0;
-    static uint8_t prev_arp_pattern = 0;
-    uint8_t drone_mode = params_get(P_DRONE_MODE);
+    uint8_t drone_mode = P->v[P_DRONE_MODE];
+    r->drone_mode = drone_mode;
+    // Arp pattern/speed: from params, or derived from the envelope knobs in drone mode
+    uint8_t arp_pattern = P->v[P_ARP_PATTERN];
+    uint8_t arp_speed = P->v[P_ARP_SPEED];
 
     if(drone_mode) {
         // Drone mode is active
-        uint8_t base_note = params_get(P_ENV_ATTACK) >> 1;  // Attack knob >> 1 = MIDI notes 0-63
+        uint8_t base_note = P->v[P_ENV_ATTACK] >> 1;  // Attack knob >> 1 = MIDI notes 0-63
 
         // Map decay knob to arpeggiator pattern (0-15)
-        uint8_t arp_pattern = (params_get(P_ENV_DECAY) * 15) / 127;
-        params_set(P_ARP_PATTERN, arp_pattern);
+        arp_pattern = (P->v[P_ENV_DECAY] * 15) / 127;
 
-        // Map release knob to arpeggiator speed (inverted: higher knob = faster)
-        uint8_t arp_speed = 255 - params_get(P_ENV_RELEASE);
-        params_set(P_ARP_SPEED, arp_speed);
+        // Map release knob to arpeggiator speed (inverted: higher knob = faster),
+        // clamped to the P_ARP_SPEED range. Kept engine-local: the audio thread
+        // never writes parameters.
+        int arp_speed_raw = 255 - P->v[P_ENV_RELEASE];
+        arp_speed = arp_speed_raw > 127 ? 127 : arp_speed_raw;
 
         // Reset arpeggiator when drone mode activates or pattern changes
-        if(!prev_drone_mode || (arp_pattern != prev_arp_pattern)) {
-            arp_step = 0;
-            arp_counter = 0;
-            arp_note_on = 0;
+        if(!e->prev_drone_mode || (arp_pattern != e->prev_arp_pattern)) {
+            e->arp_step = 0;
+            e->arp_counter = 0;
+            e->arp_note_on = 0;
         }
-        prev_arp_pattern = arp_pattern;
+        e->prev_arp_pattern = arp_pattern;
 
         // Bypass envelope: force all active voices to full sustain with level from sustain knob
-        int16_t drone_amp = params_get(P_ENV_SUSTAIN);  // 0-127
+        int16_t drone_amp = P->v[P_ENV_SUSTAIN];  // 0-127
         int16_t drone_amp_q = (drone_amp * 32767) / 127;
 
         for(int v=0; v<3; v++){
-            if(V[v].active){
+            if(e->hot[v].active){
                 // Bypass envelope entirely - set amplitude directly
-                V[v].env_q = drone_amp_q;
+                e->hot[v].env_q = drone_amp_q;
+                e->hot[v].env_lvl = (int32_t)drone_amp_q << ENV_SHIFT;
                 // Keep in sustain state so it doesn't progress through envelope
-                V[v].env = ENV_SUSTAIN;
+                e->hot[v].env = ENV_SUSTAIN;
             }
         }
 
@@ -748,259 +611,295 @@ void rockit_engine_render(rockit_engine_t *e, int16_t *out, size_t frames, int s
         (void)base_note;  // Note stored for use in sample loop
     } else {
         // Drone mode deactivated
-        if(prev_drone_mode) {
+        if(e->prev_drone_mode) {
             // Release all voices when leaving drone mode
             for(int v=0; v<3; v++){
-                if(V[v].active){
-                    V[v].env = ENV_RELEASE;
+                if(e->hot[v].active){
+                    e->hot[v].env = ENV_RELEASE;
                 }
             }
-            arp_note_on = 0;
+            e->arp_note_on = 0;
         }
     }
-    prev_drone_mode = drone_mode;
-
-    for(size_t i=0; i<frames; i++){
-        // ==== LFO MODULATION SYSTEM (matches original Rockit routing) ====
-
-        // Generate LFO waveforms (0-255 unsigned)
-        uint8_t lfo1_wave = (uint8_t)((lfo_wave(L1.ph, L1.shape) + 32768) >> 8);
-        uint8_t lfo2_wave = (uint8_t)((lfo_wave(L2.ph, L2.shape) + 32768) >> 8);
-
-        // LFO 1 Modulation Routing
-        int lfo1_dest = params_get(P_LFO1_DEST);
-        int lfo1_depth = params_get(P_LFO1_DEPTH);
-        int16_t lfo1_mod = 0;  // Modulation amount to add to parameter
-        if(lfo1_depth > 0) {
-            int16_t mod = (int16_t)lfo1_wave - 128;  // Center to bipolar (-128 to +127)
-            lfo1_mod = (mod * lfo1_depth) >> 7;      // Scale by depth, divide by 128
+    e->prev_drone_mode = drone_mode;
+
+    // Arpeggiator settings (Drone Mode Only)
+    arp_cfg_t *arp = &r->arp;
+    arp->base_note = P->v[P_ENV_ATTACK] >> 1;  // Base note from attack knob
+    arp->pattern = arp_pattern & 0x0F;          // 0-15
+    arp->length = P->v[P_ARP_LENGTH];
+    if(arp->length < 1) arp->length = 1;
+    if(arp->length > 8) arp->length = 8;
+    // Calculate step timing (samples per step)
+    // Speed 0 = slowest, 127 = fastest
+    // Map to reasonable range: ~20Hz (2400 samples @ 48kHz) to ~1Hz (48000 samples)
+    arp->step_length = 48000 - (arp_speed * 360);  // Approx range
+    arp->gate_length = (arp->step_length * P->v[P_ARP_GATE]) / 127;
+
+    // Voice settings shared by every block until the next event
+    vb->engine = (osc_engine_t)P->v[P_OSC_ENGINE];
+    vb->w1 = (wave_t)P->v[P_OSC1_WAVE];
+    vb->w2 = (wave_t)P->v[P_OSC2_WAVE];
+    if(vb->w1 > 15) vb->w1 = W_SINE;
+    if(vb->w2 > 15) vb->w2 = W_SINE;
+    // Glide time constant: 0-100 ms worth of samples
+    if(snap_changed(e, P, P_GLIDE_TIME)){
+        float glide = (float)P->v[P_GLIDE_TIME]/127.0f;
+        e->glide_rate = 0;
+        if(glide > 0.01f){
+            e->glide_rate = (uint32_t)(glide * 100.0f * (float)sr / 1000.0f);
+            if(e->glide_rate < 1) e->glide_rate = 1;
         }
+    }
+    e->derived_valid = 1;
+    vb->glide_rate = e->glide_rate;
+}
 
-        // LFO 2 Modulation Routing
-        int lfo2_dest = params_get(P_LFO2_DEST);
-        int lfo2_depth = params_get(P_LFO2_DEPTH);
-        int16_t lfo2_mod = 0;
-        if(lfo2_depth > 0) {
-            int16_t mod = (int16_t)lfo2_wave - 128;
-            lfo2_mod = (mod * lfo2_depth) >> 7;
-        }
+void rockit_engine_render(rockit_engine_t *e, int16_t *out, size_t frames, int sr){
+    rt_guard_enter();   // Debug builds (RT_GUARD=1): no allocation, locks or stdio below
+
+    if(sr != e->sr) {
+        // Rate-dependent state must follow the output rate
+        svf_init(&e->flt, sr);
+        env_table_init(&e->env_tab, sr);
+        e->cutoff_q8 = -1;
+        e->res = -1;
+        e->lfo1_rate = -1;
+        e->derived_valid = 0;
+    }
+    e->sr = sr;
 
-        // Apply LFO modulation to destinations (matching original Rockit)
-        // LFO1 destinations: 0:Amp, 1:Filter, 2:FilterQ, 3:FilterEnv, 4:Pitch, 5:Detune
-        // LFO2 destinations: 0:Mix, 1:Filter, 2:FilterQ, 3:LFO1Rate, 4:LFO1Depth, 5:FilterAtk
-
-        int16_t modulated_vol = params_get(P_MASTER_VOL);
-        int16_t modulated_mix = params_get(P_OSC_MIX);
-        int16_t modulated_tune = tune;  // Already loaded from outer scope
-
-        // LFO 1 routing (only safe per-sample modulations - no filter!)
-        switch(lfo1_dest) {
-            case 0: modulated_vol += lfo1_mod; break;       // Amplitude
-            case 1: break;  // Filter Cutoff - DISABLED (can't update coefficients per-sample)
-            case 2: break;  // Filter Q - DISABLED (can't update coefficients per-sample)
-            case 3: break;  // Filter Env Amount - not implemented yet
-            case 4: break;  // Pitch Shift - global pitch bend, complex
-            case 5: modulated_tune += lfo1_mod; break;      // Detune
-        }
+    // Pull queued MIDI. Events due at sample 0 go in before the parameter
+    // snapshot so the per-render settings below already see them.
+    events_collect(e, frames, sr);
+    events_apply_until(e, 0);
 
-        // LFO 2 routing (only safe per-sample modulations - no filter!)
-        switch(lfo2_dest) {
-            case 0: modulated_mix += lfo2_mod; break;       // OSC Mix
-            case 1: break;  // Filter Cutoff - DISABLED (can't update coefficients per-sample)
-            case 2: break;  // Filter Q - DISABLED (can't update coefficients per-sample)
-            case 3: break;  // LFO1 Rate - meta-modulation, complex
-            case 4: break;  // LFO1 Depth - meta-modulation, complex
-            case 5: break;  // Filter Attack - not implemented yet
-        }
+    // One consistent parameter view per render call (re-acquired after
+    // mid-period events, and everything derived from it recomputed, so
+    // every parameter change lands at its sample offset)
+    const params_snapshot_t *P = params_acquire(&e->params);
 
-        // Clamp modulated values to valid ranges
-        if(modulated_vol < 0) modulated_vol = 0;
-        if(modulated_vol > 127) modulated_vol = 127;
-        if(modulated_mix < 0) modulated_mix = 0;
-        if(modulated_mix > 127) modulated_mix = 127;
-        if(modulated_tune < 0) modulated_tune = 0;
-        if(modulated_tune > 127) modulated_tune = 127;
+    render_cfg_t rc;
+    voice_block_t vb;
+    render_setup(e, P, sr, &rc, &vb);
 
-        // Apply exponential curve to modulated volume (LFO tremolo affects volume curve)
-        float vol_norm_mod = modulated_vol / 127.0f;
-        int16_t vol_q_mod = (int16_t)(32767.0f * vol_norm_mod * vol_norm_mod);
+    int32_t vbuf[3][ROCKIT_CONTROL_BLOCK];
 
-        // Tick LFO phase accumulators
-        L1.ph += L1.inc;
-        L2.ph += L2.inc;
+    size_t i = 0;
+    while(i < frames){
+        // ==== LFO MODULATION SYSTEM (matches original Rockit routing) ====
+        // Evaluated once per control block, see control_update()
+        size_t n = frames - i;
+        if(n > ROCKIT_CONTROL_BLOCK) n = ROCKIT_CONTROL_BLOCK;
+
+        // ==== QUEUED MIDI ====
+        // Apply events due now and end the block at the next one
+        if(events_apply_until(e, i)){
+            P = params_acquire(&e->params);
+            render_setup(e, P, sr, &rc, &vb);
+        }
+        if(e->event_next < e->event_count){
+            size_t next = e->events[e->event_next].offset - i;
+            if(n > next) n = next;
+        }
 
         // ==== ARPEGGIATOR (Drone Mode Only) ====
-        if(drone_mode) {
-            uint8_t base_note = params_get(P_ENV_ATTACK) >> 1;  // Base note from attack knob
-            uint8_t pattern = params_get(P_ARP_PATTERN) & 0x0F; // 0-15
-            uint8_t speed = params_get(P_ARP_SPEED);
-            uint8_t length = params_get(P_ARP_LENGTH);
-            if(length < 1) length = 1;
-            if(length > 8) length = 8;
-            uint8_t gate = params_get(P_ARP_GATE);
-
-            // Calculate step timing (samples per step)
-            // Speed 0 = slowest, 127 = fastest
-            // Map to reasonable range: ~20Hz (2400 samples @ 48kHz) to ~1Hz (48000 samples)
-            uint32_t step_length = 48000 - (speed * 360);  // Approx range
-            uint32_t gate_length = (step_length * gate) / 127;
-
-            arp_counter++;
-
-            // Gate off time
-            if(arp_note_on && arp_counter >= gate_length) {
-                rockit_note_off(base_note + ARP_PATTERNS[pattern][arp_step]);
-                arp_note_on = 0;
-            }
-
-            // Advance to next step
-            if(arp_counter >= step_length) {
-                // Move to next step
-                arp_step++;
-                if(arp_step >= length) {
-                    arp_step = 0;
-                }
-
-                // Calculate note with pattern offset (clamped to MIDI range)
-                int16_t note_with_offset = base_note + ARP_PATTERNS[pattern][arp_step];
-                if(note_with_offset < 0) note_with_offset = 0;
-                if(note_with_offset > 127) note_with_offset = 127;
-
-                // Trigger note
-                rockit_note_on((uint8_t)note_with_offset);
-                arp_note_on = 1;
-                arp_counter = 0;
-            }
+        // Events land on block boundaries, so split the block at the next one
+        if(rc.drone_mode) {
+            uint32_t next = arp_tick(e, &rc.arp);
+            if(n > next) n = next;
+            e->arp_counter += (uint32_t)n - 1;
         }
 
-        // Voice summing with proper scaling
-        int32_t mix = 0;
+        control_t c;
+        control_update(e, &c, P, n, sr, rc.tune, rc.drone_mode);
+
+        // Render each active voice into its own buffer
+        vb.tune = c.tune;
+        vb.width = c.width;
+        vb.mix_q = c.mix_q;
+        vb.mix_step = c.mix_step;
         int active_voices = 0;
+        int32_t *vout[3];
         for(int v=0; v<3; v++){
-            if(V[v].active){
-                // Pass modulated tune and mix to voice_tick
-                mix += voice_tick(&V[v], sr, modulated_tune, modulated_mix);
-                active_voices++;
+            if(e->hot[v].active){
+                voice_render(&e->voice[v], &e->hot[v], vbuf[v], n, &vb);
+                vout[active_voices++] = vbuf[v];
             }
         }
 
-        // Scale by voice count to prevent clipping
-        if(active_voices > 1){
-            mix = mix / active_voices;
-        }
+        for(size_t end = i + n, k = 0; i < end; i++, k++){
+            // Voice summing with proper scaling
+            int32_t mix = 0;
+            for(int v=0; v<active_voices; v++){
+                mix += vout[v][k];
+            }
 
-        // Convert to float for filter and apply correct filter mode
-        // Original Rockit order: 0=LP, 1=BP, 2=HP (from manual section 4)
-        float sf = (float)sat16(mix) / 32768.0f;
-        switch(filter_mode) {
-            case 0: sf = svf_process_lp(&flt, sf); break;    // Lowpass
-            case 1: sf = svf_process_bp(&flt, sf); break;    // Bandpass (was HP!)
-            case 2: sf = svf_process_hp(&flt, sf); break;    // Highpass (was BP!)
-            case 3: sf = svf_process_notch(&flt, sf); break; // Notch (bonus mode)
-            default: sf = svf_process_lp(&flt, sf); break;
+            // Scale by voice count to prevent clipping
+            if(active_voices > 1){
+                mix = mix / active_voices;
+            }
+
+#ifdef ROCKIT_SVF_FIXED
+            // Fixed-point filter: Q8.23 in/out (int16 << 8), see filter_svf.h
+            // Original Rockit order: 0=LP, 1=BP, 2=HP (from manual section 4)
+            int32_t sx = (int32_t)sat16(mix) << 8;
+            switch(rc.filter_mode) {
+                case 0: sx = svf_fx_process_lp(&e->flt, sx); break;    // Lowpass
+                case 1: sx = svf_fx_process_bp(&e->flt, sx); break;    // Bandpass
+                case 2: sx = svf_fx_process_hp(&e->flt, sx); break;    // Highpass
+                case 3: sx = svf_fx_process_notch(&e->flt, sx); break; // Notch (bonus mode)
+                default: sx = svf_fx_process_lp(&e->flt, sx); break;
+            }
+            int16_t filtered = sat16((sx + 128) >> 8);
+#else
+            // Convert to float for filter and apply correct filter mode
+            // Original Rockit order: 0=LP, 1=BP, 2=HP (from manual section 4)
+            float sf = (float)sat16(mix) / 32768.0f;
+            switch(rc.filter_mode) {
+                case 0: sf = svf_process_lp(&e->flt, sf); break;    // Lowpass
+                case 1: sf = svf_process_bp(&e->flt, sf); break;    // Bandpass (was HP!)
+                case 2: sf = svf_process_hp(&e->flt, sf); break;    // Highpass (was BP!)
+                case 3: sf = svf_process_notch(&e->flt, sf); break; // Notch (bonus mode)
+                default: sf = svf_process_lp(&e->flt, sf); break;
+            }
+            int16_t filtered = (int16_t)(sf * 32768.0f);
+#endif
+
+            // Apply modulated master volume (ramped across the control block)
+            int16_t v16 = qmul_q15(filtered, (int16_t)c.vol_q);
+            c.vol_q += c.vol_step;
+
+            // STEREO OUTPUT
+            out[2*i+0] = v16;
+            out[2*i+1] = v16;
         }
-        int16_t filtered = (int16_t)(sf * 32768.0f);
-
-        // Apply modulated master volume
-        int16_t v16 = qmul_q15(filtered, vol_q_mod);
-        
-        // STEREO OUTPUT
-        out[2*i+0] = v16; 
-        out[2*i+1] = v16;
     }
+
+    rt_guard_leave();
 }
 
-void rockit_note_on(uint8_t note){
+void rockit_note_on(rockit_engine_t *e, uint8_t note){
     // Use paraphonic allocator
-    paraphonic_note_on(note, 100);
+    paraphonic_note_on(&e->para, note, 100);
     
     // Update voice states from paraphonic allocator
     voice_t voices[3];
-    paraphonic_get_voices(voices);
+    paraphonic_get_voices(&e->para, voices);
     
     for(int i=0; i<3; i++){
         // Trigger if allocator says active AND (new note OR voice was idle)
-        if(voices[i].active && (V[i].note != voices[i].note || V[i].env == ENV_IDLE)){
-            voice_trigger(&V[i], voices[i].note, g_sr);
+        if(voices[i].active && (e->voice[i].note != voices[i].note || e->hot[i].env == ENV_IDLE)){
+            voice_trigger(e, i, voices[i].note);
         }
     }
 }
 
-void rockit_note_off(uint8_t note){
+void rockit_note_off(rockit_engine_t *e, uint8_t note){
     // Use paraphonic allocator
-    paraphonic_note_off(note);
+    paraphonic_note_off(&e->para, note);
     
     // Update voice states from paraphonic allocator
     voice_t voices[3];
-    paraphonic_get_voices(voices);
+    paraphonic_get_voices(&e->para, voices);
     
     // Release voices that should no longer be active
     for(int i=0; i<3; i++){
-        if(V[i].active && V[i].note == note && !voices[i].active){
-            voice_release(&V[i]);
+        if(e->hot[i].active && e->voice[i].note == note && !voices[i].active){
+            voice_release(&e->hot[i]);
+        }
+    }
+}
+
+int rockit_handle_patch_cc(rockit_engine_t *e, uint8_t cc, uint8_t value){
+    // Patch Save/Recall (using simple text file storage instead of EEPROM)
+    switch(cc){
+        case 92: {  // Save Patch: value 0-127 maps to patch 0-15
+            uint8_t patch_num = value >> 3;  // Divide by 8: 0-7 = patch 0, 8-15 = patch 1, etc.
+            if(patch_save(&e->params, patch_num) == 0) {
+                fprintf(stderr, "✓ Saved to patch %d (CC92 value=%d)\n", patch_num, value);
+            }
+            return 1;
+        }
+        case 93: {  // Recall Patch: value 0-127 maps to patch 0-15
+            uint8_t patch_num = value >> 3;
+            if(patch_recall(&e->params, patch_num) == 0) {
+                fprintf(stderr, "✓ Recalled patch %d (CC93 value=%d)\n", patch_num, value);
+            }
+            return 1;
+        }
+        default: return 0;
+    }
+}
+
+// Channel mode messages: All Notes Off (CC 123) releases every voice, All
+// Sound Off (CC 120) silences them at once. Drone mode keeps running.
+static void all_notes_off(rockit_engine_t *e, int cut){
+    paraphonic_all_notes_off(&e->para);
+    for(int i=0; i<3; i++){
+        voice_hot_t *h = &e->hot[i];
+        if(!cut){
+            voice_release(h);
+            continue;
         }
+        h->env = ENV_IDLE;
+        h->env_lvl = 0;
+        h->env_q = 0;
+        h->active = 0;
     }
 }
 
-void rockit_handle_cc(uint8_t cc, uint8_t value){
+void rockit_handle_cc(rockit_engine_t *e, uint8_t cc, uint8_t value){
+    if(rockit_handle_patch_cc(e, cc, value)) return;
+    if(cc == 120 || cc == 123){
+        all_notes_off(e, cc == 120);
+        return;
+    }
+
     // Pass to paraphonic handler first
-    paraphonic_handle_cc(cc, value);
+    paraphonic_handle_cc(&e->para, cc, value);
 
     // Standard MIDI CC mapping (compatible with web UI and v0.9)
     switch(cc){
         // LFO 1 (primary)
-        case 1:  params_set(P_LFO1_DEPTH, value); break;             // Mod wheel
-        case 87: params_set(P_LFO1_RATE, value); break;
-        case 88: params_set(P_LFO1_SHAPE, value >> 3); break;        // 0-15 from 0-127
-        case 89: params_set(P_LFO1_DEST, value >> 4); break;         // 0-7 from 0-127
+        case 1:  params_set(&e->params, P_LFO1_DEPTH, value); break;             // Mod wheel
+        case 87: params_set(&e->params, P_LFO1_RATE, value); break;
+        case 88: params_set(&e->params, P_LFO1_SHAPE, value >> 3); break;        // 0-15 from 0-127
+        case 89: params_set(&e->params, P_LFO1_DEST, value >> 4); break;         // 0-7 from 0-127
 
         // LFO 2 (extended controls - no UI yet, placeholders for future)
-        case 95: params_set(P_LFO2_RATE, value); break;
-        case 96: params_set(P_LFO2_DEPTH, value); break;
-        case 97: params_set(P_LFO2_SHAPE, value >> 3); break;        // 0-15 from 0-127
-        case 98: params_set(P_LFO2_DEST, value >> 4); break;         // 0-7 from 0-127
+        case 95: params_set(&e->params, P_LFO2_RATE, value); break;
+        case 96: params_set(&e->params, P_LFO2_DEPTH, value); break;
+        case 97: params_set(&e->params, P_LFO2_SHAPE, value >> 3); break;        // 0-15 from 0-127
+        case 98: params_set(&e->params, P_LFO2_DEST, value >> 4); break;         // 0-7 from 0-127
 
         // Master
-        case 7:  params_set(P_MASTER_VOL, value); break;
+        case 7:  params_set(&e->params, P_MASTER_VOL, value); break;
 
         // Filter
-        case 74: params_set(P_FILTER_CUTOFF, value); break;
-        case 71: params_set(P_FILTER_RESONANCE, value); break;
-        case 84: params_set(P_FILTER_MODE, value & 0x03); break;     // Web UI sends 0-3 directly, mask to be safe
-        case 85: params_set(P_FILTER_ENV_AMT, value); break;
+        case 74: params_set(&e->params, P_FILTER_CUTOFF, value); break;
+        case 71: params_set(&e->params, P_FILTER_RESONANCE, value); break;
+        case 84: params_set(&e->params, P_FILTER_MODE, value & 0x03); break;     // Web UI sends 0-3 directly, mask to be safe
+        case 85: params_set(&e->params, P_FILTER_ENV_AMT, value); break;
 
         // Oscillators
-        case 72: params_set(P_OSC_MIX, value); break;
-        case 76: params_set(P_SUBOSC, (value>=64)?1:0); break;
-        case 80: params_set(P_OSC1_WAVE, value >> 3); break;         // 0-15 from 0-127 (16 waveforms)
-        case 81: params_set(P_OSC2_WAVE, value >> 3); break;         // 0-15 from 0-127
-        case 82: params_set(P_TUNE, value); break;                   // 0-127, center 64, ±16 semitones
+        case 72: params_set(&e->params, P_OSC_MIX, value); break;
+        case 76: params_set(&e->params, P_SUBOSC, (value>=64)?1:0); break;
+        case 80: params_set(&e->params, P_OSC1_WAVE, value >> 3); break;         // 0-15 from 0-127 (16 waveforms)
+        case 81: params_set(&e->params, P_OSC2_WAVE, value >> 3); break;         // 0-15 from 0-127
+        case 82: params_set(&e->params, P_TUNE, value); break;                   // 0-127, center 64, ±16 semitones
+        case 83: params_set(&e->params, P_OSC_ENGINE, value / 43); break;        // 0-42=Classic, 43-85=HQ, 86-127=PolyBLEP
+        case 77: params_set(&e->params, P_PULSE_WIDTH, value); break;            // 64 = square
 
         // Envelope (Amplitude)
-        case 73: params_set(P_ENV_ATTACK, value); break;
-        case 75: params_set(P_ENV_DECAY, value); break;
-        case 86: params_set(P_ENV_SUSTAIN, value); break;
-        case 70: params_set(P_ENV_RELEASE, value); break;
+        case 73: params_set(&e->params, P_ENV_ATTACK, value); break;
+        case 75: params_set(&e->params, P_ENV_DECAY, value); break;
+        case 86: params_set(&e->params, P_ENV_SUSTAIN, value); break;
+        case 70: params_set(&e->params, P_ENV_RELEASE, value); break;
 
         // Global
-        case 90: params_set(P_GLIDE_TIME, value); break;
-        case 91: params_set(P_DRONE_MODE, value >= 64 ? 1 : 0); break;  // Toggle: 0-63=off, 64-127=on
-
-        // Patch Save/Recall (using simple text file storage instead of EEPROM)
-        case 92: {  // Save Patch: value 0-127 maps to patch 0-15
-            uint8_t patch_num = value >> 3;  // Divide by 8: 0-7 = patch 0, 8-15 = patch 1, etc.
-            if(patch_save(patch_num) == 0) {
-                fprintf(stderr, "✓ Saved to patch %d (CC92 value=%d)\n", patch_num, value);
-            }
-            break;
-        }
-        case 93: {  // Recall Patch: value 0-127 maps to patch 0-15
-            uint8_t patch_num = value >> 3;
-            if(patch_recall(patch_num) == 0) {
-                fprintf(stderr, "✓ Recalled patch %d (CC93 value=%d)\n", patch_num, value);
-            }
-            break;
-        }
+        case 90: params_set(&e->params, P_GLIDE_TIME, value); break;
+        case 91: params_set(&e->params, P_DRONE_MODE, value >= 64 ? 1 : 0); break;  // Toggle: 0-63=off, 64-127=on
 
         default: break;
     }
@@ -2,13 +2,111 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "params.h"
+#include "midi_queue.h"
+#include "paraphonic.h"
+#include "oscillator.h"
+#include "envelope.h"
+#include "filter_svf.h"
+#include "lfo.h"
 
-typedef struct { 
-    uint32_t dummy; 
+// Event queues attached per engine, and events applied per render call
+// (any excess waits a period)
+#define ROCKIT_MAX_QUEUES 4
+#define ROCKIT_MAX_EVENTS 64
+
+// Per-voice hot state: everything the per-sample loop touches, packed into
+// one 32-byte D-cache line (MIPS 24KEc line size)
+typedef struct {
+    uint32_t ph1, inc1;     // OSC1 phase and increment (pitch LFO applied, set per control block)
+    uint32_t ph2, inc2;     // OSC2 phase and increment (glide + detune applied, set per block)
+    int32_t env_lvl;        // Envelope level (Q30, see envelope.h)
+    int16_t env_q;          // Envelope level (Q15) for the filter envelope
+    uint8_t env;            // env_t
+    uint8_t active;
+} __attribute__((aligned(32))) voice_hot_t;
+
+// Per-voice cold state: note, envelope times, glide and morph state
+typedef struct {
+    uint8_t note;
+    env_rates_t eg;                // Envelope slopes and sustain level
+    uint32_t inc1;                 // OSC1 base increment (no pitch LFO)
+    uint32_t inc_target, inc_cur;  // OSC2 base increment target and glide position
+    morph_state_t morph1, morph2;  // Separate morph state for OSC1 and OSC2
+    osc_tables_t tabs;             // Pre-blended wavetables for the note (both oscillators)
+} voice_state_t;
+
+// Queued MIDI event placed at a sample offset of the current render call
+typedef struct {
+    uint32_t offset;
+    uint8_t status, data1, data2;
+} pending_event_t;
+
+/*
+ * One complete synth. Everything the engine touches lives here, so any
+ * number of engines can exist in a process and each can render on its own
+ * thread. The only shared data are read-only tables (wavetables, the HQ
+ * oscillator tables built once by the first init).
+ *
+ * Fields are private to rockit_engine.c except 'params', which control
+ * threads may read and write with params_get()/params_set().
+ */
+typedef struct {
+    params_t params;                // Knobs: params_set(&e->params, ...) from any thread
+
+    paraphonic_state_t para;        // Voice allocation
+    voice_hot_t hot[3];
+    voice_state_t voice[3];
+    lfo_t lfo1, lfo2;
+    svf_t flt;
+    int sr;                         // Rate the rate-dependent state was built for
+    env_table_t env_tab;            // Envelope slopes for sr
+    osc_cache_t osc_cache;          // Pre-blended wavetables shared by the voices
+
+    // Values derived from the parameter snapshot, rebuilt only when their
+    // parameters' generations move
+    uint16_t seen_gen[P_COUNT];     // Snapshot generations the derived values were built from
+    uint8_t derived_valid;          // Cleared to rebuild every derived value
+    env_rates_t eg;                 // Envelope slopes from the knobs
+    uint32_t glide_rate;            // Glide time constant in samples
+
+    // Modulation state carried between control blocks
+    int32_t vol_q;                  // End point of the last volume ramp (-1 = jump)
+    int32_t mix_q;                  // End point of the last mix ramp (-1 = jump)
+    int32_t cutoff_q8;              // Cutoff last given to the SVF (param units << 8)
+    int res;                        // Resonance last given to the SVF
+    int lfo1_rate;                  // LFO1 rate behind lfo1.inc (LFO2 can modulate it)
+
+    // Drone mode and arpeggiator
+    uint8_t prev_drone_mode, prev_arp_pattern;
+    uint8_t arp_step;               // Current step in pattern (0-7)
+    uint32_t arp_counter;           // Sample counter for timing
+    uint8_t arp_note_on;            // Current note state (for gate)
+
+    // MIDI event queues
+    midi_queue_t *queues[ROCKIT_MAX_QUEUES];
+    int queue_count;
+    uint64_t prev_render_ns;        // Start of the previous render call (0 = none yet)
+    pending_event_t events[ROCKIT_MAX_EVENTS];
+    size_t event_count, event_next;
 } rockit_engine_t;
 
 void rockit_engine_init(rockit_engine_t *e);
 void rockit_engine_render(rockit_engine_t *e, int16_t *out, size_t frames, int sample_rate);
-void rockit_note_on(uint8_t midi_note);
-void rockit_note_off(uint8_t midi_note);
-void rockit_handle_cc(uint8_t cc, uint8_t value);
+
+// Direct control: only from the thread that renders e (other threads go
+// through an attached queue, or params_set() for plain knob values)
+void rockit_note_on(rockit_engine_t *e, uint8_t midi_note);
+void rockit_note_off(rockit_engine_t *e, uint8_t midi_note);
+void rockit_handle_cc(rockit_engine_t *e, uint8_t cc, uint8_t value);
+// Raw channel message: note on/off and CC on any channel, others ignored
+void rockit_handle_midi(rockit_engine_t *e, uint8_t status, uint8_t data1, uint8_t data2);
+
+// Event queues: the engine drains every attached queue at the start of each
+// render call and applies the events at their sample offsets, parameter
+// CCs as well as notes. Attach before the audio loop starts; returns -1 if
+// all slots are taken.
+int rockit_engine_attach_queue(rockit_engine_t *e, midi_queue_t *q);
+
+// Patch save/recall CCs (92/93) do file I/O and must not run on the audio
+// thread: producers call this first and only queue the CC if it returns 0
+int rockit_handle_patch_cc(rockit_engine_t *e, uint8_t cc, uint8_t value);
@@ -0,0 +1,155 @@
+/**
+ * Offline renderer: Standard MIDI File in, WAV out, no ALSA
+ *
+ * Plays a MIDI file (format 0 or 1) through rockit_engine_render() as fast
+ * as the CPU allows and writes 16-bit stereo PCM. Render calls are split at
+ * every event time, so each note and CC lands on its exact sample instead of
+ * a period boundary. Channel messages on every channel drive the synth, as
+ * they do live; patch save/recall CCs (92/93) are ignored so a file cannot
+ * touch the patch slots - use --patch to start from a saved patch instead
+ * (any file in the patch_storage format, e.g. /root/rockit_patches/patch_03.txt).
+ * The render continues for --tail seconds after the file ends for release
+ * tails. Prints the real-time factor achieved (audio time / render time).
+ *
+ * Host build: `make rockit_render` (host/rockit_render).
+ *
+ * Usage: rockit_render [--patch FILE] [--rate HZ] [--tail SECONDS] IN.mid OUT.wav
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rockit_engine.h"
+#include "patch_storage.h"
+#include "smf.h"
+
+#define MAX_BLOCK 256      // Frames per render call between events
+
+static double now_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void put_le(uint8_t *p, uint32_t v, int bytes){
+    for(int i=0; i<bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// 44-byte canonical header for 16-bit stereo PCM
+static int wav_write_header(FILE *fp, int rate, uint32_t frames){
+    uint8_t h[44];
+    uint32_t data_bytes = frames * 4;
+    memcpy(h, "RIFF", 4);
+    put_le(h + 4, 36 + data_bytes, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le(h + 16, 16, 4);              // fmt chunk size
+    put_le(h + 20, 1, 2);               // PCM
+    put_le(h + 22, 2, 2);               // Channels
+    put_le(h + 24, rate, 4);
+    put_le(h + 28, rate * 4, 4);        // Byte rate
+    put_le(h + 32, 4, 2);               // Block align
+    put_le(h + 34, 16, 2);              // Bits per sample
+    memcpy(h + 36, "data", 4);
+    put_le(h + 40, data_bytes, 4);
+    return fwrite(h, 1, sizeof(h), fp) == sizeof(h) ? 0 : -1;
+}
+
+static int usage(const char *argv0){
+    fprintf(stderr, "Usage: %s [--patch FILE] [--rate HZ] [--tail SECONDS] IN.mid OUT.wav\n", argv0);
+    return 1;
+}
+
+int main(int argc, char **argv){
+    const char *patch = NULL, *in = NULL, *out = NULL;
+    int rate = 48000;
+    double tail = 2.0;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--patch") == 0 && i+1 < argc) patch = argv[++i];
+        else if(strcmp(argv[i], "--rate") == 0 && i+1 < argc) rate = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--tail") == 0 && i+1 < argc) tail = atof(argv[++i]);
+        else if(argv[i][0] == '-') return usage(argv[0]);
+        else if(!in) in = argv[i];
+        else if(!out) out = argv[i];
+        else return usage(argv[0]);
+    }
+    if(!in || !out || rate < 8000 || rate > 192000 || tail < 0.0) return usage(argv[0]);
+
+    smf_t song;
+    if(smf_load(&song, in) < 0) return 1;
+
+    static rockit_engine_t engine;
+    rockit_engine_init(&engine);
+    if(patch){
+        if(patch_load_file(&engine.params, patch) <= 0){
+            fprintf(stderr, "Cannot load patch %s\n", patch);
+            smf_free(&song);
+            return 1;
+        }
+    }
+
+    FILE *fp = fopen(out, "wb");
+    if(!fp){
+        perror(out);
+        smf_free(&song);
+        return 1;
+    }
+
+    // Event times in samples; the file's end plus the tail sets the length
+    uint64_t total = (song.end_ns * rate + 500000000ull) / 1000000000ull + (uint64_t)(tail * rate);
+    if(total > 0xFFFFFFFFull / 4 - 36){
+        fprintf(stderr, "%s: too long for a WAV file\n", in);
+        fclose(fp);
+        smf_free(&song);
+        return 1;
+    }
+    wav_write_header(fp, rate, (uint32_t)total);
+
+    static int16_t buf[MAX_BLOCK * 2];
+    size_t next = 0;
+    uint64_t pos = 0;
+    double render_s = 0.0, t0 = now_s();
+    while(pos < total){
+        // Apply every event due at this sample, then render up to the next one
+        uint64_t due = total;
+        while(next < song.count){
+            const midi_event_t *ev = &song.ev[next];
+            due = (ev->t_ns * rate + 500000000ull) / 1000000000ull;
+            if(due > pos) break;
+            uint8_t status = ev->status & 0xF0;
+            if(!(status == 0xB0 && (ev->data1 == 92 || ev->data1 == 93)))
+                rockit_handle_midi(&engine, ev->status, ev->data1, ev->data2);
+            next++;
+            due = total;
+        }
+
+        size_t n = MAX_BLOCK;
+        if(due - pos < n) n = (size_t)(due - pos);
+        if(total - pos < n) n = (size_t)(total - pos);
+
+        double r0 = now_s();
+        rockit_engine_render(&engine, buf, n, rate);
+        render_s += now_s() - r0;
+
+        if(fwrite(buf, sizeof(int16_t) * 2, n, fp) != n){
+            perror(out);
+            fclose(fp);
+            smf_free(&song);
+            return 1;
+        }
+        pos += n;
+    }
+    double wall_s = now_s() - t0;
+
+    smf_free(&song);
+    if(fclose(fp) != 0){
+        perror(out);
+        return 1;
+    }
+
+    double audio_s = (double)total / rate;
+    printf("%s: %zu events, %.2f s of audio at %d Hz\n", in, next, audio_s, rate);
+    printf("Rendered in %.3f s (engine %.3f s): %.1fx real time (engine alone %.1fx)\n",
+           wall_s, render_s, audio_s / wall_s, audio_s / render_s);
+    return 0;
+}
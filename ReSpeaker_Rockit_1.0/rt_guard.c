@@ -0,0 +1,70 @@
+#include "rt_guard.h"
+
+#ifdef ROCKIT_RT_GUARD
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Nesting depth of guarded sections on this thread
+static __thread int rt_depth;
+
+void rt_guard_enter(void){ rt_depth++; }
+void rt_guard_leave(void){ rt_depth--; }
+int rt_guard_active(void){ return rt_depth > 0; }
+
+// Report with write(2) only: stdio and malloc are what we are trapping
+static void rt_violation(const char *fn){
+    static const char pre[] = "rt_guard: ";
+    static const char post[] = "() called from the real-time render path\n";
+    if(write(2, pre, sizeof(pre) - 1) < 0 ||
+       write(2, fn, strlen(fn)) < 0 ||
+       write(2, post, sizeof(post) - 1) < 0){
+        // Nothing more we can do; abort regardless
+    }
+    abort();
+}
+
+#define RT_CHECK(fn) do { if(rt_depth > 0) rt_violation(fn); } while(0)
+
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t n);
+void __real_free(void *p);
+int __real_pthread_mutex_lock(pthread_mutex_t *m);
+FILE *__real_fopen(const char *path, const char *mode);
+size_t __real_fwrite(const void *p, size_t size, size_t n, FILE *fp);
+int __real_fputs(const char *s, FILE *fp);
+int __real_puts(const char *s);
+
+void *__wrap_malloc(size_t n){ RT_CHECK("malloc"); return __real_malloc(n); }
+void *__wrap_calloc(size_t n, size_t size){ RT_CHECK("calloc"); return __real_calloc(n, size); }
+void *__wrap_realloc(void *p, size_t n){ RT_CHECK("realloc"); return __real_realloc(p, n); }
+void __wrap_free(void *p){ RT_CHECK("free"); __real_free(p); }
+int __wrap_pthread_mutex_lock(pthread_mutex_t *m){ RT_CHECK("pthread_mutex_lock"); return __real_pthread_mutex_lock(m); }
+FILE *__wrap_fopen(const char *path, const char *mode){ RT_CHECK("fopen"); return __real_fopen(path, mode); }
+size_t __wrap_fwrite(const void *p, size_t size, size_t n, FILE *fp){ RT_CHECK("fwrite"); return __real_fwrite(p, size, n, fp); }
+int __wrap_fputs(const char *s, FILE *fp){ RT_CHECK("fputs"); return __real_fputs(s, fp); }
+int __wrap_puts(const char *s){ RT_CHECK("puts"); return __real_puts(s); }
+
+// The printf family forwards to the v* variants, which are not wrapped
+int __wrap_printf(const char *fmt, ...){
+    RT_CHECK("printf");
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+int __wrap_fprintf(FILE *fp, const char *fmt, ...){
+    RT_CHECK("fprintf");
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(fp, fmt, ap);
+    va_end(ap);
+    return n;
+}
+#endif
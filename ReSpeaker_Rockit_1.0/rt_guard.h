@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+ * Real-time guard for debug builds (make RT_GUARD=1, -DROCKIT_RT_GUARD).
+ *
+ * rockit_engine_render() brackets itself with rt_guard_enter()/leave(), and
+ * the allocator, mutex and stdio entry points are wrapped at link time
+ * (-Wl,--wrap=..., RT_GUARD_WRAP in the Makefile): reaching one of them
+ * from inside the render call tree prints the function and aborts. The
+ * wrap only sees calls made from our own objects, not calls libc makes
+ * internally. In normal builds both calls compile to nothing.
+ */
+
+#ifdef ROCKIT_RT_GUARD
+void rt_guard_enter(void);
+void rt_guard_leave(void);
+int rt_guard_active(void);
+#else
+static inline void rt_guard_enter(void){}
+static inline void rt_guard_leave(void){}
+static inline int rt_guard_active(void){ return 0; }
+#endif
@@ -0,0 +1,244 @@
+// Standard MIDI File reader, see smf.h
+
+#include "smf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define DEFAULT_TEMPO 500000u   // us per quarter note (120 BPM) until the first Set Tempo
+
+// Event in tick time, before the tempo map is applied
+typedef struct {
+    uint64_t tick;
+    uint32_t seq;           // File order: tie-break for equal ticks
+    uint32_t tempo;         // Set Tempo (status 0xFF) in us per quarter note
+    uint8_t status, data1, data2;
+} smf_raw_t;
+
+typedef struct {
+    smf_raw_t *ev;
+    size_t count, cap;
+} raw_list_t;
+
+static uint32_t be32(const uint8_t *p){
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t be16(const uint8_t *p){
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// a * b / c without overflowing a * b (b * c must fit in 64 bits)
+static uint64_t mul_div(uint64_t a, uint64_t b, uint64_t c){
+    return (a / c) * b + (a % c) * b / c;
+}
+
+static int raw_push(raw_list_t *l, const smf_raw_t *r){
+    if(l->count == l->cap){
+        size_t cap = l->cap ? l->cap * 2 : 1024;
+        smf_raw_t *ev = realloc(l->ev, cap * sizeof(*ev));
+        if(!ev) return -1;
+        l->ev = ev;
+        l->cap = cap;
+    }
+    l->ev[l->count++] = *r;
+    return 0;
+}
+
+// Variable-length quantity (at most 4 bytes)
+static int read_vlq(const uint8_t **p, const uint8_t *end, uint32_t *out){
+    uint32_t v = 0;
+    for(int i=0; i<4; i++){
+        if(*p >= end) return -1;
+        uint8_t b = *(*p)++;
+        v = (v << 7) | (b & 0x7F);
+        if(!(b & 0x80)){
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_track(raw_list_t *l, const uint8_t *p, const uint8_t *end,
+                       uint32_t *seq, uint64_t *end_tick){
+    uint64_t tick = 0;
+    uint8_t running = 0;
+
+    while(p < end){
+        uint32_t delta, len;
+        if(read_vlq(&p, end, &delta) < 0 || p >= end) return -1;
+        tick += delta;
+
+        uint8_t status = *p;
+        if(status & 0x80) p++;
+        else if(running) status = running;      // Running status: reuse the last channel status
+        else return -1;
+
+        if(status == 0xFF){                     // Meta event
+            if(p >= end) return -1;
+            uint8_t type = *p++;
+            if(read_vlq(&p, end, &len) < 0 || len > (size_t)(end - p)) return -1;
+            if(type == 0x51 && len == 3){       // Set Tempo
+                smf_raw_t r = { tick, (*seq)++, ((uint32_t)p[0] << 16) | (p[1] << 8) | p[2], 0xFF, 0, 0 };
+                if(r.tempo == 0) r.tempo = 1;
+                if(raw_push(l, &r) < 0) return -1;
+            }
+            p += len;
+            running = 0;
+            if(type == 0x2F) break;             // End of Track
+        } else if(status == 0xF0 || status == 0xF7){   // Sysex: skipped
+            if(read_vlq(&p, end, &len) < 0 || len > (size_t)(end - p)) return -1;
+            p += len;
+            running = 0;
+        } else if(status > 0xF0){
+            return -1;                          // System messages are not valid in a file
+        } else {
+            int n = ((status & 0xE0) == 0xC0) ? 1 : 2;  // Program change, channel pressure
+            if(end - p < n) return -1;
+            smf_raw_t r = { tick, (*seq)++, 0, status, p[0] & 0x7F, n == 2 ? p[1] & 0x7F : 0 };
+            if(raw_push(l, &r) < 0) return -1;
+            p += n;
+            running = status;
+        }
+    }
+
+    if(tick > *end_tick) *end_tick = tick;
+    return 0;
+}
+
+static int raw_cmp(const void *a, const void *b){
+    const smf_raw_t *x = a, *y = b;
+    if(x->tick != y->tick) return x->tick < y->tick ? -1 : 1;
+    return x->seq < y->seq ? -1 : (x->seq > y->seq);
+}
+
+int smf_parse(smf_t *s, const uint8_t *data, size_t len){
+    memset(s, 0, sizeof(*s));
+    if(len < 14 || memcmp(data, "MThd", 4) != 0 || be32(data + 4) < 6 || be32(data + 4) > len - 8){
+        fprintf(stderr, "smf: not a MIDI file\n");
+        return -1;
+    }
+    uint16_t format = be16(data + 8), ntrks = be16(data + 10), division = be16(data + 12);
+    if(format > 1){
+        fprintf(stderr, "smf: format %d not supported (0 and 1 only)\n", format);
+        return -1;
+    }
+
+    // Tick length as num/den ns: PPQ scales with the tempo, SMPTE is fixed
+    uint64_t num, den;
+    int smpte = division & 0x8000;
+    if(smpte){
+        int fps = -(int8_t)(division >> 8), tpf = division & 0xFF;
+        if(fps <= 0 || tpf == 0){
+            fprintf(stderr, "smf: bad SMPTE division\n");
+            return -1;
+        }
+        num = 1000000000ull;
+        den = (uint64_t)fps * tpf;
+        if(fps == 29){                          // 29.97 fps drop-frame
+            num = 100100000ull;
+            den = 3ull * tpf;
+        }
+    } else {
+        if(division == 0){
+            fprintf(stderr, "smf: zero ticks per quarter note\n");
+            return -1;
+        }
+        num = DEFAULT_TEMPO * 1000ull;
+        den = division;
+    }
+
+    raw_list_t l = { 0 };
+    uint32_t seq = 0;
+    uint64_t end_tick = 0;
+    int tracks = 0;
+    const uint8_t *p = data + 8 + be32(data + 4), *end = data + len;
+    while(tracks < ntrks && end - p >= 8){
+        uint32_t clen = be32(p + 4);
+        if(clen > (size_t)(end - p) - 8){
+            fprintf(stderr, "smf: truncated chunk\n");
+            goto fail;
+        }
+        if(memcmp(p, "MTrk", 4) == 0){          // Unknown chunks are skipped
+            if(parse_track(&l, p + 8, p + 8 + clen, &seq, &end_tick) < 0){
+                fprintf(stderr, "smf: track %d is malformed\n", tracks);
+                goto fail;
+            }
+            tracks++;
+        }
+        p += 8 + clen;
+    }
+    if(tracks < ntrks){
+        fprintf(stderr, "smf: expected %d tracks, found %d\n", ntrks, tracks);
+        goto fail;
+    }
+
+    qsort(l.ev, l.count, sizeof(*l.ev), raw_cmp);
+
+    // Apply the tempo map
+    s->ev = malloc((l.count ? l.count : 1) * sizeof(*s->ev));
+    if(!s->ev){
+        fprintf(stderr, "smf: out of memory\n");
+        goto fail;
+    }
+    uint64_t base_tick = 0, base_ns = 0;
+    for(size_t i=0; i<l.count; i++){
+        const smf_raw_t *r = &l.ev[i];
+        uint64_t ns = base_ns + mul_div(r->tick - base_tick, num, den);
+        if(r->status == 0xFF){
+            if(!smpte){
+                base_tick = r->tick;
+                base_ns = ns;
+                num = r->tempo * 1000ull;
+            }
+            continue;
+        }
+        midi_event_t *ev = &s->ev[s->count++];
+        ev->t_ns = ns;
+        ev->status = r->status;
+        ev->data1 = r->data1;
+        ev->data2 = r->data2;
+    }
+    s->end_ns = base_ns + mul_div(end_tick - base_tick, num, den);
+
+    free(l.ev);
+    return 0;
+
+fail:
+    free(l.ev);
+    smf_free(s);
+    return -1;
+}
+
+int smf_load(smf_t *s, const char *path){
+    memset(s, 0, sizeof(*s));
+    FILE *fp = fopen(path, "rb");
+    if(!fp){
+        fprintf(stderr, "smf: cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint8_t *data = len > 0 ? malloc(len) : NULL;
+    if(!data || fread(data, 1, len, fp) != (size_t)len){
+        fprintf(stderr, "smf: cannot read %s\n", path);
+        free(data);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    int r = smf_parse(s, data, len);
+    free(data);
+    return r;
+}
+
+void smf_free(smf_t *s){
+    free(s->ev);
+    s->ev = NULL;
+    s->count = 0;
+}
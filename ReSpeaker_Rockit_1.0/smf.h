@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "midi_queue.h"
+
+/*
+ * Standard MIDI File reader (formats 0 and 1) for offline rendering.
+ *
+ * Every track is flattened into one list of channel messages sorted by
+ * time, t_ns being the time from the start of the file through the tempo
+ * map (Set Tempo events from any track, PPQ or SMPTE division). Running
+ * status is expanded; meta and sysex events are dropped. Program change
+ * and channel pressure carry data2 = 0. Events at the same tick keep file
+ * order, earlier tracks first.
+ */
+
+typedef struct {
+    midi_event_t *ev;
+    size_t count;
+    uint64_t end_ns;        // Time of the last event in any track (End of Track included)
+} smf_t;
+
+// Parse a file image. Returns 0, or -1 (with a message on stderr) if the
+// data is not a valid SMF. s->ev must be released with smf_free().
+int smf_parse(smf_t *s, const uint8_t *data, size_t len);
+
+// Read and parse a file
+int smf_load(smf_t *s, const char *path);
+
+void smf_free(smf_t *s);
@@ -1,52 +1,138 @@
 #include "socket_midi_raw.h"
+#include "midi_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <errno.h>
 
-#define MIDI_STATUS_NOTE_ON 0x90
-#define MIDI_STATUS_NOTE_OFF 0x80
-#define MIDI_STATUS_CC 0xB0
-#define MESSAGE_SIZE 3 // Standard MIDI message size
+#define SOCKET_THREAD_STACK (64 * 1024)
+#define MAX_CLIENTS 8       // Concurrent connections (web bridge, sequencers, scripts)
+#define LISTEN_BACKLOG 16
+#define READ_CHUNK 256
+#define POLL_MS 200         // Poll timeout: how soon socket_midi_raw_stop() is noticed
+#define MAX_DATAGRAM 1536   // Largest datagram read (512 packed 3-byte messages)
+#define DGRAM_RCVBUF (256 * 1024)  // Absorbs bursts while the thread is not scheduled
+
+// One connection: clients stay connected and stream MIDI bytes, each with
+// its own parser state (running status survives across reads)
+typedef struct {
+    int fd;                 // -1 = free slot
+    midi_parser_t parser;
+} client_t;
 
 static pthread_t th;
 static int running = 0;
-static void (*cb_note_on)(uint8_t) = NULL;
-static void (*cb_note_off)(uint8_t) = NULL;
-static void (*cb_cc)(uint8_t, uint8_t) = NULL;
-
-static void parse_midi_bytes(const uint8_t* buffer) {
-    uint8_t status = buffer[0] & 0xF0; // Get command (ignore channel)
-    uint8_t data1 = buffer[1];
-    uint8_t data2 = buffer[2];
-
-    if (status == MIDI_STATUS_NOTE_ON) {
-        // Note On with velocity 0 is treated as Note Off
-        if (data2 > 0) { 
-            if (cb_note_on) cb_note_on(data1);
-        } else { 
-            if (cb_note_off) cb_note_off(data1);
+static client_t clients[MAX_CLIENTS];
+static int udp_port = -1;   // -1 = the TCP port, 0 = off
+static char unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)] = SOCKET_MIDI_UNIX_PATH;
+static midi_handlers_t handlers;
+
+static void client_accept(int listenfd) {
+    int connfd = accept(listenfd, (struct sockaddr*)NULL, (socklen_t*)NULL);
+    if (connfd < 0) {
+        if (running && errno != EINTR && errno != EAGAIN) perror("Socket accept failed");
+        return;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd < 0) {
+            clients[i].fd = connfd;
+            midi_parser_init(&clients[i].parser);
+            return;
         }
-    } else if (status == MIDI_STATUS_NOTE_OFF) {
-        if (cb_note_off) cb_note_off(data1);
-    } else if (status == MIDI_STATUS_CC) {
-        if (cb_cc) cb_cc(data1, data2);
     }
+    fprintf(stderr, "Warning: MIDI socket full (%d clients), connection refused\n", MAX_CLIENTS);
+    close(connfd);
+}
+
+// Read what the client sent and dispatch every complete message; closes the
+// connection on EOF or error
+static void client_read(client_t *c) {
+    uint8_t buf[READ_CHUNK], msg[3];
+    ssize_t n = read(c->fd, buf, sizeof(buf));
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) return;
+    if (n <= 0) {
+        close(c->fd);
+        c->fd = -1;
+        return;
+    }
+    for (ssize_t i = 0; i < n; i++) {
+        if (midi_parser_feed(&c->parser, buf[i], msg) == 3) midi_dispatch(&handlers, msg);
+    }
+}
+
+// One datagram holds one or more whole messages; running status does not
+// carry over between datagrams (they may come from different senders)
+static void datagram_read(int fd) {
+    uint8_t buf[MAX_DATAGRAM], msg[3];
+    ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n <= 0) return;
+    midi_parser_t parser;
+    midi_parser_init(&parser);
+    for (ssize_t i = 0; i < n; i++) {
+        if (midi_parser_feed(&parser, buf[i], msg) == 3) midi_dispatch(&handlers, msg);
+    }
+}
+
+static void datagram_rcvbuf(int fd) {
+    int size = DGRAM_RCVBUF;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+}
+
+static int udp_open(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("UDP socket creation failed");
+        return -1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("UDP bind failed");
+        close(fd); return -1;
+    }
+    datagram_rcvbuf(fd);
+    fprintf(stderr, "RAW MIDI UDP: Listening on 127.0.0.1:%u (datagrams of packed messages)\n", port);
+    return fd;
+}
+
+static int unix_open(void) {
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("Unix socket creation failed");
+        return -1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, unix_path, sizeof(addr.sun_path));   // Same size, NUL-terminated
+    unlink(unix_path);  // Left over from a previous run
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("Unix socket bind failed");
+        close(fd); return -1;
+    }
+    chmod(unix_path, 0666);  // Any local user's tools may play
+    datagram_rcvbuf(fd);
+    fprintf(stderr, "RAW MIDI UNIX: Listening on %s (datagrams of packed messages)\n", unix_path);
+    return fd;
 }
 
 static void* socket_thread(void* arg) {
     uint16_t port = *(uint16_t*)arg;
     free(arg); 
     
-    int listenfd, connfd;
+    int listenfd;
     struct sockaddr_in serv_addr;
-    uint8_t recv_buf[MESSAGE_SIZE];
-    int n;
     int optval = 1; 
 
     listenfd = socket(AF_INET, SOCK_STREAM, 0);
@@ -66,50 +152,97 @@ static void* socket_thread(void* arg) {
         perror("Socket bind failed");
         close(listenfd); return NULL;
     }
-    if (listen(listenfd, 1) < 0) {
+    if (listen(listenfd, LISTEN_BACKLOG) < 0) {
         perror("Socket listen failed");
         close(listenfd); return NULL;
     }
 
-    fprintf(stderr, "RAW MIDI TUNNEL: Listening on 127.0.0.1:%u (3-byte packets)\n", port);
+    fprintf(stderr, "RAW MIDI TUNNEL: Listening on 127.0.0.1:%u (MIDI byte stream, up to %d clients)\n",
+            port, MAX_CLIENTS);
+
+    for (int i = 0; i < MAX_CLIENTS; i++) clients[i].fd = -1;
+
+    // Datagram transports share this thread (and so the engine's queue)
+    int udpfd = udp_port ? udp_open(udp_port < 0 ? port : (uint16_t)udp_port) : -1;
+    int unixfd = unix_path[0] ? unix_open() : -1;
 
     while (running) {
-        // Blocks until a connection is received
-        connfd = accept(listenfd, (struct sockaddr*)NULL, (socklen_t*)NULL);
-        if (connfd < 0) {
-            if (running) perror("Socket accept failed");
-            continue;
+        // Listener and datagram sockets first, then every connected client
+        struct pollfd fds[3 + MAX_CLIENTS];
+        client_t *owner[3 + MAX_CLIENTS];
+        int nfds = 0;
+        fds[nfds].fd = listenfd;
+        fds[nfds].events = POLLIN;
+        owner[nfds++] = NULL;
+        fds[nfds].fd = udpfd;       // Negative fds are ignored by poll()
+        fds[nfds].events = POLLIN;
+        owner[nfds++] = NULL;
+        fds[nfds].fd = unixfd;
+        fds[nfds].events = POLLIN;
+        owner[nfds++] = NULL;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) continue;
+            fds[nfds].fd = clients[i].fd;
+            fds[nfds].events = POLLIN;
+            owner[nfds++] = &clients[i];
         }
 
-        // Read exactly 3 bytes (the raw MIDI message)
-        n = read(connfd, recv_buf, MESSAGE_SIZE);
-        if (n == MESSAGE_SIZE) {
-            parse_midi_bytes(recv_buf);
-        } else if (n > 0) {
-            fprintf(stderr, "Warning: Received %d bytes, expected 3 (MIDI msg)\n", n);
+        int ready = poll(fds, nfds, POLL_MS);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                perror("Socket poll failed");
+                break;
+            }
+            continue;
+        }
+        for (int i = 0; i < nfds && ready > 0; i++) {
+            if (!fds[i].revents) continue;
+            ready--;
+            if (owner[i]) client_read(owner[i]);
+            else if (fds[i].fd == listenfd) client_accept(listenfd);
+            else datagram_read(fds[i].fd);
         }
-
-        close(connfd);
     }
 
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) close(clients[i].fd);
+        clients[i].fd = -1;
+    }
     close(listenfd);
+    if (udpfd >= 0) close(udpfd);
+    if (unixfd >= 0) {
+        close(unixfd);
+        unlink(unix_path);
+    }
     return NULL;
 }
 
+void socket_midi_raw_set_datagram(int port, const char *path) {
+    udp_port = port;
+    snprintf(unix_path, sizeof(unix_path), "%s", path ? path : "");
+}
+
 int socket_midi_raw_start(uint16_t port,
                           void (*on_note_on)(uint8_t), 
                           void (*on_note_off)(uint8_t),
                           void (*on_cc)(uint8_t, uint8_t)) {
     if (running) return 0;
     
-    cb_note_on = on_note_on; cb_note_off = on_note_off; cb_cc = on_cc;
+    handlers.note_on = on_note_on; handlers.note_off = on_note_off; handlers.cc = on_cc;
     running = 1;
     
     uint16_t* port_arg = (uint16_t*)malloc(sizeof(uint16_t));
     if (!port_arg) return -1;
     *port_arg = port;
     
-    if (pthread_create(&th, NULL, socket_thread, port_arg) != 0) {
+    // Small explicit stack: the libc default (often 8 MB) would all be
+    // locked by main.c --realtime
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, SOCKET_THREAD_STACK);
+    int err = pthread_create(&th, &attr, socket_thread, port_arg);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
         perror("Socket thread creation failed");
         free(port_arg); running = 0; return -1;
     }
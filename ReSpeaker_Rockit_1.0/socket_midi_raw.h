@@ -1,10 +1,21 @@
 #pragma once
 #include <stdint.h>
 
-// Starts a thread listening on the loopback address for 3-byte MIDI messages
+#define SOCKET_MIDI_UNIX_PATH "/tmp/rockit_midi.sock"
+
+// Starts a thread listening on the loopback address for MIDI. Clients may
+// stay connected and stream messages (running status allowed); a client
+// that sends one 3-byte message per connection works too. The same thread
+// also reads datagrams (UDP on the loopback, and an AF_UNIX SOCK_DGRAM
+// socket), each holding one or more packed messages.
 int socket_midi_raw_start(uint16_t port,
                           void (*on_note_on)(uint8_t), 
                           void (*on_note_off)(uint8_t),
                           void (*on_cc)(uint8_t, uint8_t));
 
-void socket_midi_raw_stop(void);
\ No newline at end of file
+void socket_midi_raw_stop(void);
+
+// Datagram listeners, before socket_midi_raw_start(): UDP port (-1 = the
+// TCP port, the default; 0 = off) and Unix socket path (NULL or "" = off;
+// SOCKET_MIDI_UNIX_PATH by default)
+void socket_midi_raw_set_datagram(int port, const char *path);
\ No newline at end of file
@@ -0,0 +1,100 @@
+/**
+ * Channel mode message test (host build)
+ *
+ * All Sound Off (CC 120) must silence held notes within a couple of periods
+ * (only the filter tail may ring on), All Notes Off (CC 123) must release
+ * them through the envelope, and neither may leave notes in the paraphonic
+ * stack: in mono mode a fresh note played and released afterwards must fade
+ * out instead of falling back to one of the notes held before the panic.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "rockit_engine.h"
+
+#define SR 48000
+#define PERIOD 256
+#define QUIET 64            // Peak below which a period counts as silent
+
+static rockit_engine_t e;
+static int16_t buf[PERIOD * 2];
+
+// Peak of one rendered period
+static int render_peak(void){
+    rockit_engine_render(&e, buf, PERIOD, SR);
+    int peak = 0;
+    for(int i=0; i<PERIOD * 2; i++){
+        int a = abs(buf[i]);
+        if(a > peak) peak = a;
+    }
+    return peak;
+}
+
+// Periods until the output stays quiet for 10 periods in a row (-1: never)
+static int periods_to_silence(int limit){
+    int quiet = 0;
+    for(int p=0; p<limit; p++){
+        quiet = render_peak() < QUIET ? quiet + 1 : 0;
+        if(quiet == 10) return p - 9;
+    }
+    return -1;
+}
+
+static void hold_chord(void){
+    rockit_engine_init(&e);
+    rockit_handle_cc(&e, 70, 100);      // Long release, so a release and a cut differ
+    rockit_note_on(&e, 48);
+    rockit_note_on(&e, 55);
+    rockit_note_on(&e, 60);
+    for(int p=0; p<20; p++) render_peak();
+}
+
+int main(void){
+    int fail = 0;
+
+    hold_chord();
+    int held = periods_to_silence(200);
+    printf("Held chord:        %s\n", held < 0 ? "still sounding after 200 periods" : "went silent");
+    if(held >= 0) fail = 1;
+
+    hold_chord();
+    rockit_handle_cc(&e, 120, 0);
+    int cut = periods_to_silence(200);
+    printf("All Sound Off:     silent after %d periods\n", cut);
+    if(cut < 0 || cut > 2) fail = 1;
+
+    hold_chord();
+    rockit_handle_cc(&e, 123, 0);
+    int sounding = render_peak();
+    int rel = periods_to_silence(2000);
+    printf("All Notes Off:     peak %d on the next period, silent after %d periods\n", sounding, rel);
+    if(sounding < QUIET || rel <= cut || rel < 0) fail = 1;
+
+    // Mono mode: with the stack cleared, releasing the new note ends the sound
+    for(int c=120; c<=123; c+=3){
+        rockit_engine_init(&e);
+        rockit_handle_cc(&e, 102, 0);
+        rockit_note_on(&e, 48);
+        rockit_note_on(&e, 55);
+        for(int p=0; p<10; p++) render_peak();
+        rockit_handle_cc(&e, (uint8_t)c, 0);
+        for(int p=0; p<10; p++) render_peak();
+        rockit_note_on(&e, 60);
+        int played = 0;
+        for(int p=0; p<10; p++){
+            int pk = render_peak();
+            if(pk > played) played = pk;
+        }
+        rockit_note_off(&e, 60);
+        int after = periods_to_silence(2000);
+        printf("Mono after CC %d: new note peak %d, silent %d periods after its release\n", c, played, after);
+        if(played < QUIET || after < 0) fail = 1;
+    }
+
+    if(fail){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: All Sound Off cuts, All Notes Off releases, and both clear held notes ***\n");
+    return 0;
+}
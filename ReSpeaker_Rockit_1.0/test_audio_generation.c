@@ -8,13 +8,13 @@ int main() {
     rockit_engine_init(&engine);
     
     printf("Testing audio generation...\n");
-    printf("Master Volume: %d\n", params_get(P_MASTER_VOL));
-    printf("Filter Cutoff: %d\n", params_get(P_FILTER_CUTOFF));
-    printf("Filter Resonance: %d\n", params_get(P_FILTER_RESONANCE));
+    printf("Master Volume: %d\n", params_get(&engine.params, P_MASTER_VOL));
+    printf("Filter Cutoff: %d\n", params_get(&engine.params, P_FILTER_CUTOFF));
+    printf("Filter Resonance: %d\n", params_get(&engine.params, P_FILTER_RESONANCE));
     
     // Trigger note 60 (middle C)
     printf("\nTriggering note 60...\n");
-    rockit_note_on(60);
+    rockit_note_on(&engine, 60);
     
     // Render 4800 samples (100ms at 48kHz)
     int16_t buffer[4800 * 2]; // stereo
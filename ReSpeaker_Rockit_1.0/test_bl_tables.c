@@ -0,0 +1,67 @@
+/**
+ * Generated mipmap test (host build, tables from `make tables`)
+ *
+ * - every note's level keeps its highest harmonic below Nyquist at the top
+ *   of the note's semitone
+ * - each level's spectrum (DFT) has nothing above its harmonic count beyond
+ *   8-bit quantisation noise
+ * - levels are monotonic: higher notes never get more harmonics
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "wavetables_bl.h"
+
+#define NOISE_DB -40.0    // Max out-of-band bin relative to the fundamental
+
+static const uint8_t (*const SHAPES[])[BL_LEN] = { BL_SQUARE, BL_RAMP, BL_TRIANGLE, BL_PARABOLIC };
+static const char *NAMES[] = { "square", "ramp", "triangle", "parabolic" };
+
+static double bin_mag(const uint8_t *t, int k){
+    double re = 0.0, im = 0.0;
+    for(int i=0; i<BL_LEN; i++){
+        double x = (double)t[i] - 128.0;
+        re += x * cos(2.0 * M_PI * k * i / BL_LEN);
+        im -= x * sin(2.0 * M_PI * k * i / BL_LEN);
+    }
+    return sqrt(re * re + im * im);
+}
+
+int main(void){
+    int fail = 0;
+    printf("Generated tables: %d Hz, %d levels x %d\n", BL_RATE, BL_LEVELS, BL_LEN);
+
+    for(int n=0; n<128; n++){
+        int l = BL_NOTE_LEVEL[n];
+        double f_top = 440.0 * pow(2.0, (n + 1.0 - 69.0) / 12.0);
+        if(l >= BL_LEVELS || BL_LEVEL_HARMONICS[l] * f_top >= BL_RATE * 0.5){
+            printf("  note %d: level %d (%d harmonics) aliases\n", n, l, BL_LEVEL_HARMONICS[l]);
+            fail = 1;
+        }
+        if(n > 0 && l < BL_NOTE_LEVEL[n-1]){
+            printf("  note %d: level goes back down\n", n);
+            fail = 1;
+        }
+    }
+
+    for(int s=0; s<4; s++){
+        double worst = -1000.0;
+        for(int l=0; l<BL_LEVELS; l++){
+            double ref = bin_mag(SHAPES[s][l], 1);
+            for(int k=BL_LEVEL_HARMONICS[l] + 1; k<BL_LEN/2; k++){
+                double db = 20.0 * log10(bin_mag(SHAPES[s][l], k) / ref + 1e-12);
+                if(db > worst) worst = db;
+            }
+        }
+        int ok = worst < NOISE_DB;
+        printf("  %-10s worst out-of-band bin %6.1f dB %s\n", NAMES[s], worst, ok ? "ok" : "FAIL");
+        fail |= !ok;
+    }
+
+    if(fail){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: generated mipmaps are band-limited for %d Hz ***\n", BL_RATE);
+    return 0;
+}
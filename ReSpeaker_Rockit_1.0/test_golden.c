@@ -0,0 +1,295 @@
+/**
+ * Golden-output regression test (host build)
+ *
+ * Renders a fixed matrix of scenarios through rockit_engine_render() - every
+ * waveform on every oscillator engine that implements it, each filter mode,
+ * the paraphonic modes, every LFO destination, glide, and drone with the
+ * arpeggiator - and compares an FNV-1a hash of each output against
+ * test_golden.txt. Any change to the sound, however small, fails here;
+ * after an intentional change regenerate the hashes with
+ * `host/test_golden --update` (and host/test_golden_fixed) and review the diff.
+ *
+ * Hashes are kept per build ("float" and "fixed" SVF with the default
+ * tables); builds without golden hashes (e.g. BL_TABLES=1) skip the hash
+ * check. The fixed-point build is lossy by design, so it is also compared
+ * against the float build's output (--write / --reference) and must stay
+ * within MIN_SNR_DB of it in every scenario.
+ *
+ * Usage: test_golden [--update] [--write FILE] [--reference FILE]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rockit_engine.h"
+
+#define SR 48000
+#define PERIOD 256
+#define PERIODS 120         // 0.64 s per scenario
+#define FRAMES (PERIOD * PERIODS)
+#define GOLDEN_FILE "test_golden.txt"
+#define MAX_SCENARIOS 64
+#define MIN_SNR_DB 50.0     // Fixed-point SVF against the float reference
+
+#ifdef ROCKIT_SVF_FIXED
+#define BUILD "fixed"
+#else
+#define BUILD "float"
+#endif
+
+#if defined(ROCKIT_BL_TABLES) || (defined(ROCKIT_CONTROL_BLOCK) && ROCKIT_CONTROL_BLOCK != 32)
+#define HAVE_GOLDEN 0       // Different tables or block size: no hashes kept
+#else
+#define HAVE_GOLDEN 1
+#endif
+
+typedef struct {
+    char name[32];
+    uint8_t cc[12][2];
+    int n_cc;
+} scenario_t;
+
+static scenario_t scenarios[MAX_SCENARIOS];
+static int n_scenarios;
+
+static const char *WAVE_NAMES[16] = {
+    "sine", "square", "saw", "tri", "morph1", "morph2", "morph3", "morph4",
+    "morph5", "morph6", "morph7", "morph8", "morph9", "hardsync", "noise", "rawsq",
+};
+
+static scenario_t *add(const char *name){
+    scenario_t *s = &scenarios[n_scenarios++];
+    memset(s, 0, sizeof(*s));
+    snprintf(s->name, sizeof(s->name), "%s", name);
+    return s;
+}
+
+static void cc(scenario_t *s, uint8_t num, uint8_t value){
+    s->cc[s->n_cc][0] = num;
+    s->cc[s->n_cc][1] = value;
+    s->n_cc++;
+}
+
+static void build_matrix(void){
+    static const char *ENGINES[3] = { "classic", "hq", "blep" };
+    static const char *MODES[4] = { "lp", "bp", "hp", "notch" };
+    static const char *PARA[5] = { "mono", "low", "last", "rr", "high" };
+    char name[32];
+
+    // Waveforms: both oscillators, detuned, on each engine that renders them
+    for(int w=0; w<16; w++){
+        for(int e=0; e<3; e++){
+            if(e == OSC_ENGINE_HQ && w > W_TRI) continue;
+            if(e == OSC_ENGINE_BLEP && w != W_SQUARE && w != W_SAW && w != W_TRI && w != W_RAW_SQUARE) continue;
+            snprintf(name, sizeof(name), "wave/%s/%s", WAVE_NAMES[w], ENGINES[e]);
+            scenario_t *s = add(name);
+            cc(s, 83, (uint8_t)(e * 64 - (e == 2)));    // 0, 64, 127
+            cc(s, 80, (uint8_t)(w << 3));
+            cc(s, 81, (uint8_t)(w << 3));
+            cc(s, 82, 67);
+            cc(s, 77, 40);                              // Pulse width (blep square, raw square)
+        }
+    }
+
+    // Filter modes: resonant saw with the filter envelope
+    for(int m=0; m<4; m++){
+        snprintf(name, sizeof(name), "filter/%s", MODES[m]);
+        scenario_t *s = add(name);
+        cc(s, 80, W_SAW << 3);
+        cc(s, 84, (uint8_t)m);
+        cc(s, 74, 50);
+        cc(s, 71, 100);
+        cc(s, 85, 90);
+    }
+
+    // Paraphonic modes: CC 102 = 0 selects mono, each CC 104 steps to the next mode
+    for(int p=0; p<5; p++){
+        snprintf(name, sizeof(name), "para/%s", PARA[p]);
+        scenario_t *s = add(name);
+        cc(s, 102, 0);
+        for(int i=0; i<p; i++) cc(s, 104, 0);
+    }
+    cc(add("para/2voice"), 103, 0);         // Three voices is the default
+
+    // LFO1 destinations (triangle) and LFO2 on the mix
+    for(int d=0; d<7; d++){
+        snprintf(name, sizeof(name), "lfo1/dest%d", d);
+        scenario_t *s = add(name);
+        cc(s, 80, W_SQUARE << 3);
+        cc(s, 87, 90);
+        cc(s, 1, 100);
+        cc(s, 88, 3 << 3);
+        cc(s, 89, (uint8_t)(d << 4));
+    }
+    scenario_t *s = add("lfo2/mix");
+    cc(s, 95, 70);
+    cc(s, 96, 100);
+    cc(s, 97, 0);
+    cc(s, 98, 0);
+
+    s = add("glide");
+    cc(s, 102, 0);
+    cc(s, 90, 80);
+    cc(s, 80, W_SAW << 3);
+
+    s = add("drone/arp");
+    cc(s, 73, 96);          // Base note 48
+    cc(s, 75, 64);          // Pattern 7
+    cc(s, 86, 100);         // Level
+    cc(s, 70, 100);         // Speed
+    cc(s, 91, 127);
+}
+
+// Overlapping three-note phrase, then release. Not in pitch order, so the
+// low/last/high note priorities all differ.
+static void render(const scenario_t *s, int16_t *out){
+    static rockit_engine_t e;
+    rockit_engine_init(&e);
+    for(int i=0; i<s->n_cc; i++) rockit_handle_cc(&e, s->cc[i][0], s->cc[i][1]);
+    for(int p=0; p<PERIODS; p++){
+        switch(p){
+            case 0:  rockit_note_on(&e, 60); break;
+            case 10: rockit_note_on(&e, 48); break;
+            case 20: rockit_note_on(&e, 55); break;
+            case 50: rockit_note_off(&e, 48); break;
+            case 60: rockit_note_off(&e, 60); break;
+            case 80: rockit_note_off(&e, 55); break;
+        }
+        rockit_engine_render(&e, out + (size_t)p * PERIOD * 2, PERIOD, SR);
+    }
+}
+
+static uint32_t fnv1a(const int16_t *x, size_t n){
+    uint32_t h = 2166136261u;
+    for(size_t i=0; i<n; i++){
+        h ^= (uint16_t)x[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Golden hashes for this build from the file; returns the number found
+static int load_golden(uint32_t *hash, int *found){
+    FILE *fp = fopen(GOLDEN_FILE, "r");
+    int count = 0;
+    memset(found, 0, sizeof(int) * MAX_SCENARIOS);
+    if(!fp) return 0;
+    char line[128], build[16], name[64];
+    unsigned h;
+    while(fgets(line, sizeof(line), fp)){
+        if(line[0] == '#' || sscanf(line, "%15s %63s %x", build, name, &h) != 3) continue;
+        if(strcmp(build, BUILD) != 0) continue;
+        for(int i=0; i<n_scenarios; i++){
+            if(strcmp(scenarios[i].name, name) == 0){
+                hash[i] = h;
+                found[i] = 1;
+                count++;
+            }
+        }
+    }
+    fclose(fp);
+    return count;
+}
+
+// Rewrite this build's lines, keeping every other build's
+static int update_golden(const uint32_t *hash){
+    char keep[MAX_SCENARIOS * 4][128];
+    int n_keep = 0;
+    FILE *fp = fopen(GOLDEN_FILE, "r");
+    if(fp){
+        char line[128], build[16];
+        while(fgets(line, sizeof(line), fp) && n_keep < MAX_SCENARIOS * 4){
+            if(line[0] == '#' || sscanf(line, "%15s", build) != 1 || strcmp(build, BUILD) == 0) continue;
+            snprintf(keep[n_keep++], sizeof(keep[0]), "%s", line);
+        }
+        fclose(fp);
+    }
+    fp = fopen(GOLDEN_FILE, "w");
+    if(!fp){
+        perror(GOLDEN_FILE);
+        return 1;
+    }
+    fprintf(fp, "# Golden output hashes for test_golden.c: <build> <scenario> <FNV-1a of the output>\n");
+    fprintf(fp, "# Regenerate with host/test_golden --update and host/test_golden_fixed --update\n");
+    for(int i=0; i<n_keep; i++) fputs(keep[i], fp);
+    for(int i=0; i<n_scenarios; i++) fprintf(fp, "%s %s %08x\n", BUILD, scenarios[i].name, hash[i]);
+    fclose(fp);
+    printf("Updated %d %s hashes in %s\n", n_scenarios, BUILD, GOLDEN_FILE);
+    return 0;
+}
+
+static double snr_db(const int16_t *ref, const int16_t *x, size_t n){
+    double sig = 0.0, err = 0.0;
+    for(size_t i=0; i<n; i++){
+        double d = (double)x[i] - ref[i];
+        sig += (double)ref[i] * ref[i];
+        err += d * d;
+    }
+    if(err == 0.0) return INFINITY;
+    return 10.0 * log10((sig + 1.0) / err);
+}
+
+int main(int argc, char **argv){
+    const char *write_path = NULL, *ref_path = NULL;
+    int update = 0;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--update") == 0) update = 1;
+        else if(strcmp(argv[i], "--write") == 0 && i+1 < argc) write_path = argv[++i];
+        else if(strcmp(argv[i], "--reference") == 0 && i+1 < argc) ref_path = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--update] [--write FILE] [--reference FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    build_matrix();
+    static int16_t out[FRAMES * 2], ref[FRAMES * 2];
+    static uint32_t hash[MAX_SCENARIOS], golden[MAX_SCENARIOS];
+    static int found[MAX_SCENARIOS];
+    int have = HAVE_GOLDEN ? load_golden(golden, found) : 0;
+    FILE *wfp = write_path ? fopen(write_path, "wb") : NULL;
+    FILE *rfp = ref_path ? fopen(ref_path, "rb") : NULL;
+    if((write_path && !wfp) || (ref_path && !rfp)){
+        perror(write_path && !wfp ? write_path : ref_path);
+        return 1;
+    }
+
+    int fail = 0;
+    printf("%d scenarios, %s SVF%s\n", n_scenarios, BUILD,
+           have ? "" : " (no golden hashes for this build: hash check skipped)");
+    for(int i=0; i<n_scenarios; i++){
+        render(&scenarios[i], out);
+        hash[i] = fnv1a(out, FRAMES * 2);
+        if(wfp) fwrite(out, sizeof(out), 1, wfp);
+
+        int ok = 1;
+        printf("  %-22s %08x", scenarios[i].name, hash[i]);
+        if(have && !update){
+            if(!found[i]) printf(" (no golden hash)"), ok = 0;
+            else if(hash[i] != golden[i]) printf(" != golden %08x", golden[i]), ok = 0;
+        }
+        if(rfp){
+            if(fread(ref, sizeof(ref), 1, rfp) != 1){
+                printf(" reference truncated");
+                ok = 0;
+            } else {
+                double snr = snr_db(ref, out, FRAMES * 2);
+                printf("  %6.1f dB vs reference", snr);
+                if(snr < MIN_SNR_DB) ok = 0;
+            }
+        }
+        printf(" %s\n", ok ? "ok" : "FAIL");
+        fail |= !ok;
+    }
+    if(wfp) fclose(wfp);
+    if(rfp) fclose(rfp);
+
+    if(update) return update_golden(hash) || fail;
+    if(fail){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: output matches the golden renders ***\n");
+    return 0;
+}
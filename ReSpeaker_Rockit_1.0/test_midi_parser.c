@@ -0,0 +1,290 @@
+/**
+ * MIDI stream parser and socket server test (host build)
+ *
+ * 1. Parser: running status, real-time bytes inside a message and inside
+ *    SysEx, SysEx skipped, system common cancelling running status,
+ *    one-byte messages, stray data bytes dropped.
+ * 2. Server: two clients stay connected and stream at once (one with
+ *    running status, written in odd-sized pieces so messages straddle
+ *    reads) while a legacy client opens a connection per 3-byte message,
+ *    and UDP and Unix-socket clients send datagrams of packed messages
+ *    (running status inside a datagram). Every message must arrive, in
+ *    order per TCP client.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/un.h>
+#include "midi_parser.h"
+#include "socket_midi_raw.h"
+
+#define PORT 50321
+#define STREAM_NOTES 5000
+#define STREAM_CCS 5000
+#define LEGACY_MSGS 50
+#define DGRAMS 200
+#define DGRAM_MSGS 4        // Messages per datagram
+#define UNIX_PATH "/tmp/test_midi_parser.sock"
+
+static int errors;
+
+static void expect_msg(int got, const uint8_t *msg, int len, uint8_t s, uint8_t d1, uint8_t d2, const char *what){
+    if(got != len || (got && (msg[0] != s || msg[1] != d1 || msg[2] != d2))){
+        printf("  %s: got %d [%02X %02X %02X], expected %d [%02X %02X %02X]\n",
+               what, got, msg[0], msg[1], msg[2], len, s, d1, d2);
+        errors++;
+    }
+}
+
+// Feed a byte string; collect the messages it produces
+static int feed(midi_parser_t *p, const uint8_t *in, size_t n, uint8_t out[][3], int *lens){
+    int count = 0;
+    for(size_t i=0; i<n; i++){
+        uint8_t msg[3];
+        int len = midi_parser_feed(p, in[i], msg);
+        if(len){
+            memcpy(out[count], msg, 3);
+            lens[count++] = len;
+        }
+    }
+    return count;
+}
+
+static void test_parser(void){
+    static const uint8_t STREAM[] = {
+        0x90, 0x3C, 0x64,           // Note on
+        0x40, 0x50,                 // Running status: note on
+        0x43, 0xF8, 0x00,           // Running status, clock inside the message
+        0xF0, 0x7E, 0xFA, 0x01, 0xF7,  // SysEx with a real-time start inside
+        0x44, 0x10,                 // SysEx cancelled running status: dropped
+        0xB1, 0x4A, 0x7F, 0x4A, 0x00,  // CC, running status
+        0xC2, 0x05, 0x06,           // Program change, running status
+        0xF3, 0x02,                 // Song select
+        0x10,                       // Cancelled running status: dropped
+        0xF6,                       // Tune request
+        0xE0, 0x00, 0x40,           // Pitch bend
+        0xF0, 0x01, 0x02,           // SysEx ended by the next status
+        0x80, 0x3C, 0x00,
+    };
+    static const uint8_t EXPECT[][4] = {
+        { 3, 0x90, 0x3C, 0x64 }, { 3, 0x90, 0x40, 0x50 }, { 1, 0xF8, 0, 0 }, { 3, 0x90, 0x43, 0x00 },
+        { 1, 0xFA, 0, 0 }, { 3, 0xB1, 0x4A, 0x7F }, { 3, 0xB1, 0x4A, 0x00 },
+        { 2, 0xC2, 0x05, 0 }, { 2, 0xC2, 0x06, 0 }, { 2, 0xF3, 0x02, 0 }, { 1, 0xF6, 0, 0 },
+        { 3, 0xE0, 0x00, 0x40 }, { 3, 0x80, 0x3C, 0x00 },
+    };
+    const int n_expect = (int)(sizeof(EXPECT) / sizeof(EXPECT[0]));
+    midi_parser_t p;
+    midi_parser_init(&p);
+    uint8_t out[32][3];
+    int lens[32];
+    int count = feed(&p, STREAM, sizeof(STREAM), out, lens);
+    if(count != n_expect){
+        printf("  parser: %d messages, expected %d\n", count, n_expect);
+        errors++;
+    }
+    for(int i=0; i<count && i<n_expect; i++){
+        char what[32];
+        snprintf(what, sizeof(what), "parser message %d", i);
+        expect_msg(lens[i], out[i], EXPECT[i][0], EXPECT[i][1], EXPECT[i][2], EXPECT[i][3], what);
+    }
+    if(p.dropped != 3){
+        printf("  parser: %u stray bytes dropped, expected 3\n", p.dropped);
+        errors++;
+    }
+    printf("Parser: %d messages from %zu bytes, %u dropped\n", count, sizeof(STREAM), p.dropped);
+}
+
+// Server side: counters written by the socket thread
+static uint32_t notes_on, notes_off, ccs, legacy, udp_msgs, unix_msgs, order_errors;
+static uint8_t next_note = 0, next_cc = 0;
+
+static void on_note_on(uint8_t note){
+    if(note != next_note) order_errors++;
+    next_note = (uint8_t)((note + 1) & 0x7F);
+    __atomic_fetch_add(&notes_on, 1, __ATOMIC_RELAXED);
+}
+
+static void on_note_off(uint8_t note){
+    (void)note;
+    __atomic_fetch_add(&notes_off, 1, __ATOMIC_RELAXED);
+}
+
+static void on_cc(uint8_t cc, uint8_t value){
+    if(cc == 74){
+        if(value != next_cc) order_errors++;
+        next_cc = (uint8_t)((value + 1) & 0x7F);
+        __atomic_fetch_add(&ccs, 1, __ATOMIC_RELAXED);
+    } else if(cc == 20){
+        __atomic_fetch_add(&legacy, 1, __ATOMIC_RELAXED);
+    } else if(cc == 21){
+        __atomic_fetch_add(&udp_msgs, 1, __ATOMIC_RELAXED);
+    } else if(cc == 22){
+        __atomic_fetch_add(&unix_msgs, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static int connect_port(void){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(PORT);
+    for(int tries=0; tries<100; tries++){
+        if(connect(fd, (struct sockaddr *)&a, sizeof(a)) == 0) return fd;
+        usleep(10000);      // Server thread still starting
+    }
+    close(fd);
+    return -1;
+}
+
+static int write_all(int fd, const uint8_t *p, size_t n){
+    while(n > 0){
+        ssize_t w = write(fd, p, n);
+        if(w <= 0) return -1;
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+// Note ons with running status, each followed by a velocity-0 off, in 1-7 byte writes
+static void *note_client(void *arg){
+    (void)arg;
+    static uint8_t buf[1 + STREAM_NOTES * 4];
+    size_t n = 0;
+    buf[n++] = 0x90;
+    for(int i=0; i<STREAM_NOTES; i++){
+        buf[n++] = (uint8_t)(i & 0x7F);
+        buf[n++] = 100;
+        buf[n++] = (uint8_t)(i & 0x7F);
+        buf[n++] = 0;
+    }
+    int fd = connect_port();
+    if(fd < 0) return (void *)1;
+    for(size_t off=0, step=1; off<n; off+=step, step=step % 7 + 1){
+        if(write_all(fd, buf + off, off + step > n ? n - off : step) < 0) break;
+    }
+    close(fd);
+    return NULL;
+}
+
+static void *cc_client(void *arg){
+    (void)arg;
+    static uint8_t buf[STREAM_CCS * 3];
+    for(int i=0; i<STREAM_CCS; i++){
+        buf[i*3+0] = 0xB0;
+        buf[i*3+1] = 74;
+        buf[i*3+2] = (uint8_t)(i & 0x7F);
+    }
+    int fd = connect_port();
+    if(fd < 0) return (void *)1;
+    write_all(fd, buf, sizeof(buf));
+    close(fd);
+    return NULL;
+}
+
+static void *legacy_client(void *arg){
+    (void)arg;
+    for(int i=0; i<LEGACY_MSGS; i++){
+        const uint8_t msg[3] = { 0xB0, 20, (uint8_t)i };
+        int fd = connect_port();
+        if(fd < 0) return (void *)1;
+        write_all(fd, msg, 3);
+        close(fd);
+    }
+    return NULL;
+}
+
+// Datagrams of DGRAM_MSGS CCs, running status after the first
+static void *dgram_client(void *arg){
+    int is_unix = arg != NULL;
+    int fd = socket(is_unix ? AF_UNIX : AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in in;
+    struct sockaddr_un un;
+    memset(&in, 0, sizeof(in));
+    in.sin_family = AF_INET;
+    in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    in.sin_port = htons(PORT);
+    memset(&un, 0, sizeof(un));
+    un.sun_family = AF_UNIX;
+    strcpy(un.sun_path, UNIX_PATH);
+    struct sockaddr *to = is_unix ? (struct sockaddr *)&un : (struct sockaddr *)&in;
+    socklen_t len = is_unix ? sizeof(un) : sizeof(in);
+    for(int d=0; d<DGRAMS; d++){
+        uint8_t buf[1 + DGRAM_MSGS * 2];
+        size_t n = 0;
+        buf[n++] = 0xB0;
+        for(int m=0; m<DGRAM_MSGS; m++){
+            buf[n++] = is_unix ? 22 : 21;
+            buf[n++] = (uint8_t)m;
+        }
+        if(sendto(fd, buf, n, 0, to, len) != (ssize_t)n){
+            close(fd);
+            return (void *)1;
+        }
+        if(d % 20 == 19) usleep(1000);     // UDP drops on overflow: let the server keep up
+    }
+    close(fd);
+    return NULL;
+}
+
+static void test_server(void){
+    socket_midi_raw_set_datagram(PORT, UNIX_PATH);
+    if(socket_midi_raw_start(PORT, on_note_on, on_note_off, on_cc) < 0){
+        printf("  server failed to start\n");
+        errors++;
+        return;
+    }
+    usleep(100000);         // Datagram sockets are bound by the server thread
+    pthread_t th[5];
+    void *(*fn[5])(void *) = { note_client, cc_client, legacy_client, dgram_client, dgram_client };
+    for(int i=0; i<5; i++) pthread_create(&th[i], NULL, fn[i], i == 4 ? (void *)1 : NULL);
+    for(int i=0; i<5; i++){
+        void *r;
+        pthread_join(th[i], &r);
+        if(r){
+            printf("  client %d could not connect\n", i);
+            errors++;
+        }
+    }
+    // Clients are done writing; give the server time to drain
+    for(int t=0; t<500; t++){
+        if(__atomic_load_n(&notes_off, __ATOMIC_RELAXED) == STREAM_NOTES &&
+           __atomic_load_n(&ccs, __ATOMIC_RELAXED) == STREAM_CCS &&
+           __atomic_load_n(&legacy, __ATOMIC_RELAXED) == LEGACY_MSGS &&
+           __atomic_load_n(&udp_msgs, __ATOMIC_RELAXED) == DGRAMS * DGRAM_MSGS &&
+           __atomic_load_n(&unix_msgs, __ATOMIC_RELAXED) == DGRAMS * DGRAM_MSGS) break;
+        usleep(10000);
+    }
+    socket_midi_raw_stop();
+
+    printf("Server: %u/%d notes on, %u/%d off, %u/%d CCs, %u/%d legacy messages, %u out of order\n",
+           notes_on, STREAM_NOTES, notes_off, STREAM_NOTES, ccs, STREAM_CCS, legacy, LEGACY_MSGS, order_errors);
+    printf("Datagrams: %u/%d UDP messages, %u/%d Unix socket messages\n",
+           udp_msgs, DGRAMS * DGRAM_MSGS, unix_msgs, DGRAMS * DGRAM_MSGS);
+    if(notes_on != STREAM_NOTES || notes_off != STREAM_NOTES || ccs != STREAM_CCS ||
+       legacy != LEGACY_MSGS || order_errors) errors++;
+    if(udp_msgs != DGRAMS * DGRAM_MSGS || unix_msgs != DGRAMS * DGRAM_MSGS) errors++;
+    if(access(UNIX_PATH, F_OK) == 0){
+        printf("  %s left behind\n", UNIX_PATH);
+        errors++;
+    }
+}
+
+int main(void){
+    test_parser();
+    test_server();
+    if(errors){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: MIDI streams parse and clients are served concurrently ***\n");
+    return 0;
+}
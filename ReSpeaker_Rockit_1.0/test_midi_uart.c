@@ -0,0 +1,163 @@
+/**
+ * UART MIDI input test (host build, a pseudo-terminal stands in for the UART)
+ *
+ * midi_uart_raw_start() opens the pty's slave side at the MIDI rate (a pty
+ * takes termios2 rates like a current serial driver); the test writes a
+ * MIDI stream into the master side the way a keyboard would: running
+ * status, clock bytes between and inside messages, a SysEx dump, active
+ * sensing, and messages split across writes. Every note and CC must
+ * arrive, in order, the line must be in raw mode with VMIN 1 / VTIME 0 at
+ * 31250 baud, and stop must return promptly and restore the line and rate.
+ */
+
+#define _GNU_SOURCE     // posix_openpt() and friends
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <termios.h>
+#include "midi_uart_raw.h"
+#include "uart_baud.h"
+
+#define NOTES 500
+
+static uint8_t log_status[4 * NOTES], log_d1[4 * NOTES], log_d2[4 * NOTES];
+static uint32_t log_n;
+
+static void record(uint8_t status, uint8_t d1, uint8_t d2){
+    uint32_t n = __atomic_load_n(&log_n, __ATOMIC_RELAXED);
+    if(n >= sizeof(log_status)) return;
+    log_status[n] = status;
+    log_d1[n] = d1;
+    log_d2[n] = d2;
+    __atomic_store_n(&log_n, n + 1, __ATOMIC_RELEASE);
+}
+
+static void on_note_on(uint8_t note){ record(0x90, note, 0); }
+static void on_note_off(uint8_t note){ record(0x80, note, 0); }
+static void on_cc(uint8_t cc, uint8_t value){ record(0xB0, cc, value); }
+
+// Line settings and rate as another process would see them
+static int line_get(const char *path, struct termios *tio, unsigned *baud){
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0 || tcgetattr(fd, tio) < 0){
+        perror(path);
+        if(fd >= 0) close(fd);
+        return -1;
+    }
+    *baud = uart_baud_get(fd);
+    close(fd);
+    return 0;
+}
+
+static double now_s(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(void){
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0 || grantpt(master) < 0 || unlockpt(master) < 0){
+        perror("posix_openpt");
+        return 1;
+    }
+    const char *slave = ptsname(master);
+    int errors = 0;
+    struct termios before, tio;
+    unsigned before_baud, baud;
+    if(line_get(slave, &before, &before_baud) < 0) return 1;
+
+    if(midi_uart_raw_start(slave, on_note_on, on_note_off, on_cc) < 0){
+        printf("midi_uart_raw_start(%s) failed\n", slave);
+        return 1;
+    }
+    if(line_get(slave, &tio, &baud) < 0) return 1;
+    if((tio.c_lflag & (ICANON | ECHO | ISIG)) || (tio.c_iflag & (IXON | ICRNL)) ||
+       tio.c_cc[VMIN] != 1 || tio.c_cc[VTIME] != 0 || baud != MIDI_UART_BAUD){
+        printf("  line not raw at %d baud: lflag %o iflag %o VMIN %d VTIME %d, %u baud\n", MIDI_UART_BAUD,
+               (unsigned)tio.c_lflag, (unsigned)tio.c_iflag, tio.c_cc[VMIN], tio.c_cc[VTIME], baud);
+        errors++;
+    }
+
+    // Keyboard stream: note on/off pairs under running status, a clock
+    // byte every few messages (sometimes mid-message), then a SysEx and a
+    // CC sweep after a new status
+    static uint8_t stream[8 * NOTES + 64];
+    size_t n = 0;
+    stream[n++] = 0x90;
+    for(int i=0; i<NOTES; i++){
+        stream[n++] = (uint8_t)(36 + i % 48);
+        if(i % 5 == 0) stream[n++] = 0xF8;          // Clock inside a message
+        stream[n++] = 100;
+        stream[n++] = (uint8_t)(36 + i % 48);
+        stream[n++] = 0;                            // Velocity 0: note off
+        if(i % 7 == 0) stream[n++] = 0xFE;          // Active sensing
+    }
+    static const uint8_t TAIL[] = {
+        0xF0, 0x43, 0x10, 0x4C, 0x00, 0x00, 0x7E, 0x00, 0xF7,   // SysEx (skipped)
+        0xB3, 74, 10, 74, 20, 0xF8, 74, 30,                     // CCs on channel 4
+        0x83, 60, 0,                                            // Note off status
+    };
+    memcpy(stream + n, TAIL, sizeof(TAIL));
+    n += sizeof(TAIL);
+
+    // Written in uneven pieces, as a UART FIFO would deliver them
+    for(size_t off=0, step=1; off<n; off+=step, step=step % 11 + 1){
+        size_t len = off + step > n ? n - off : step;
+        if(write(master, stream + off, len) != (ssize_t)len){
+            perror("write");
+            return 1;
+        }
+    }
+
+    uint32_t expect = 2 * NOTES + 4;
+    double deadline = now_s() + 5.0;
+    while(__atomic_load_n(&log_n, __ATOMIC_ACQUIRE) < expect && now_s() < deadline) usleep(1000);
+
+    double t0 = now_s();
+    midi_uart_raw_stop();
+    double stop_ms = (now_s() - t0) * 1000.0;
+    if(line_get(slave, &tio, &baud) < 0) return 1;
+    if(tio.c_lflag != before.c_lflag || tio.c_iflag != before.c_iflag || tio.c_cc[VMIN] != before.c_cc[VMIN] ||
+       baud != before_baud){
+        printf("  stop did not restore the line\n");
+        errors++;
+    }
+    close(master);
+
+    if(log_n != expect){
+        printf("  %u messages, expected %u\n", log_n, expect);
+        errors++;
+    }
+    for(uint32_t i=0; i<2 * NOTES && i<log_n; i++){
+        uint8_t note = (uint8_t)(36 + (i / 2) % 48);
+        uint8_t status = (i & 1) ? 0x80 : 0x90;
+        if(log_status[i] != status || log_d1[i] != note){
+            if(errors++ < 5) printf("  message %u: %02X %d, expected %02X %d\n", i, log_status[i], log_d1[i], status, note);
+        }
+    }
+    static const uint8_t TAIL_EXPECT[4][3] = { { 0xB0, 74, 10 }, { 0xB0, 74, 20 }, { 0xB0, 74, 30 }, { 0x80, 60, 0 } };
+    for(int i=0; i<4 && 2 * NOTES + i < (int)log_n; i++){
+        uint32_t k = 2 * NOTES + i;
+        if(log_status[k] != TAIL_EXPECT[i][0] || log_d1[k] != TAIL_EXPECT[i][1] || log_d2[k] != TAIL_EXPECT[i][2]){
+            printf("  tail message %d: %02X %d %d\n", i, log_status[k], log_d1[k], log_d2[k]);
+            errors++;
+        }
+    }
+    if(stop_ms > 500.0){
+        printf("  stop took %.0f ms\n", stop_ms);
+        errors++;
+    }
+
+    printf("UART (pty): %u/%u messages from %zu bytes, stop in %.0f ms\n", log_n, expect, n, stop_ms);
+    if(errors){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: UART MIDI stream parses in order ***\n");
+    return 0;
+}
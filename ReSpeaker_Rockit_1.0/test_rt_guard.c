@@ -0,0 +1,128 @@
+/**
+ * Real-time guard test (host build, -DROCKIT_RT_GUARD with the link-time wraps)
+ *
+ * 1. Clean render path: notes and every CC number with random values go
+ *    through a queue, so rockit_engine_render() applies them itself, across
+ *    all oscillator engines, filter modes and paraphonic modes. Nothing in
+ *    that call tree may allocate, lock a mutex or touch stdio. Queued patch
+ *    CCs (92/93, file I/O) must be skipped, not executed.
+ * 2. The guard works: malloc, pthread_mutex_lock and a direct patch recall
+ *    (fopen) inside a guarded section must abort.
+ *
+ * Each case runs in a forked child so a violation is reported, not fatal.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include "rockit_engine.h"
+#include "rt_guard.h"
+
+#define SR 48000
+#define PERIOD 256
+#define PERIODS 3000        // 16 s of audio
+
+static rockit_engine_t engine;
+static midi_queue_t q;
+static int16_t out[PERIOD * 2];
+
+static void clean_render(void){
+    rockit_engine_init(&engine);
+    midi_queue_init(&q);
+    rockit_engine_attach_queue(&engine, &q);
+    uint32_t seed = 12345;
+    for(int p=0; p<PERIODS; p++){
+        for(int k=0; k<4; k++){
+            seed = seed * 1664525u + 1013904223u;
+            uint8_t d1 = (uint8_t)((seed >> 8) & 0x7F), d2 = (uint8_t)((seed >> 16) & 0x7F);
+            switch((seed >> 28) & 3){
+                case 0:  midi_queue_push(&q, 0x90, (uint8_t)(36 + (d1 % 48)), (uint8_t)(d2 | 1)); break;
+                case 1:  midi_queue_push(&q, 0x80, (uint8_t)(36 + (d1 % 48)), 0); break;
+                default: midi_queue_push(&q, 0xB0, d1, d2); break;
+            }
+        }
+        if(p % 500 == 0){
+            midi_queue_push(&q, 0xB0, 93, 0);   // Patch recall: must not reach fopen()
+            midi_queue_push(&q, 0xB0, 92, 120); // Patch save: must not reach fopen()
+        }
+        rockit_engine_render(&engine, out, PERIOD, SR);
+    }
+}
+
+static void guarded_malloc(void){
+    rt_guard_enter();
+    void *volatile p = malloc(64);
+    rt_guard_leave();
+    free(p);
+}
+
+static void guarded_mutex(void){
+    static pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+    rt_guard_enter();
+    pthread_mutex_lock(&m);
+    rt_guard_leave();
+}
+
+static void guarded_patch_recall(void){
+    rockit_engine_init(&engine);
+    rt_guard_enter();
+    rockit_handle_cc(&engine, 93, 0);
+    rt_guard_leave();
+}
+
+// Run fn in a child; returns the signal that ended it, 0 for a clean exit
+static int run_child(void (*fn)(void), int quiet){
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0){
+        perror("fork");
+        exit(1);
+    }
+    if(pid == 0){
+        if(quiet){
+            int fd = open("/dev/null", O_WRONLY);
+            if(fd >= 0) dup2(fd, 2);
+        }
+        fn();
+        _exit(0);
+    }
+    int status;
+    if(waitpid(pid, &status, 0) < 0){
+        perror("waitpid");
+        exit(1);
+    }
+    if(WIFSIGNALED(status)) return WTERMSIG(status);
+    return WEXITSTATUS(status) ? -1 : 0;
+}
+
+int main(void){
+    int fail = 0;
+
+    int r = run_child(clean_render, 0);
+    printf("Render %d periods with random notes and CCs: %s\n", PERIODS,
+           r == 0 ? "no violations" : "VIOLATION");
+    fail |= r != 0;
+
+    static const struct { const char *name; void (*fn)(void); } traps[] = {
+        { "malloc", guarded_malloc },
+        { "pthread_mutex_lock", guarded_mutex },
+        { "patch recall (fopen)", guarded_patch_recall },
+    };
+    for(size_t i=0; i<sizeof(traps) / sizeof(traps[0]); i++){
+        r = run_child(traps[i].fn, 1);
+        printf("  Guarded %-22s %s\n", traps[i].name, r == SIGABRT ? "aborted" : "NOT CAUGHT");
+        fail |= r != SIGABRT;
+    }
+
+    if(fail){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: the render path is allocation-, lock- and stdio-free ***\n");
+    return 0;
+}
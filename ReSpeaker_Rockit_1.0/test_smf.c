@@ -0,0 +1,120 @@
+/**
+ * Standard MIDI File reader test (host build)
+ *
+ * 1. Format 1 with a tempo change in the conductor track: events from the
+ *    second track land at the right times across the change, running status
+ *    and velocity-0 note-offs are expanded, sysex and meta events dropped,
+ *    one-byte messages (program change) parsed.
+ * 2. SMPTE division (25 fps x 40 ticks = 1 ms per tick).
+ * 3. Malformed files (truncated track, data byte without running status)
+ *    are rejected.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "smf.h"
+
+#define MS 1000000ull
+
+static const uint8_t TEMPO_FILE[] = {
+    'M','T','h','d', 0,0,0,6, 0,1, 0,2, 0x01,0xE0,          // Format 1, 2 tracks, 480 PPQ
+    'M','T','r','k', 0,0,0,19,
+    0x00, 0xFF,0x51,0x03, 0x07,0xA1,0x20,                   // t=0: 120 BPM
+    0x87,0x40, 0xFF,0x51,0x03, 0x0F,0x42,0x40,              // tick 960 (1 s): 60 BPM
+    0x00, 0xFF,0x2F,0x00,
+    'M','T','r','k', 0,0,0,37,
+    0x00, 0x90,0x3C,0x64,                                   // t=0: note on
+    0x83,0x60, 0x3C,0x00,                                   // tick 480: running status, velocity 0
+    0x00, 0xF0,0x03,0x01,0x02,0xF7,                         // Sysex (dropped)
+    0x00, 0xFF,0x01,0x02,'h','i',                           // Text (dropped)
+    0x87,0x40, 0x90,0x40,0x64,                              // tick 1440: 1 s + 480 ticks at 60 BPM
+    0x00, 0xC0,0x05,                                        // Program change
+    0x81,0x70, 0xB0,0x4A,0x7F,                              // tick 1680: +0.5 s
+    0x00, 0xFF,0x2F,0x00,
+};
+
+static const midi_event_t TEMPO_EXPECT[] = {
+    { 0,        0x90, 0x3C, 0x64 },
+    { 500 * MS, 0x90, 0x3C, 0x00 },
+    { 2000 * MS, 0x90, 0x40, 0x64 },
+    { 2000 * MS, 0xC0, 0x05, 0x00 },
+    { 2500 * MS, 0xB0, 0x4A, 0x7F },
+};
+
+static const uint8_t SMPTE_FILE[] = {
+    'M','T','h','d', 0,0,0,6, 0,0, 0,1, 0xE7,0x28,          // Format 0, -25 fps, 40 ticks/frame
+    'M','T','r','k', 0,0,0,13,
+    0x00, 0x90,0x3C,0x64,
+    0x81,0x7A, 0x80,0x3C,0x40,                              // tick 250 = 250 ms
+    0x00, 0xFF,0x2F,0x00,
+};
+
+static const uint8_t TRUNCATED_FILE[] = {
+    'M','T','h','d', 0,0,0,6, 0,0, 0,1, 0x01,0xE0,
+    'M','T','r','k', 0,0,0,3,
+    0x00, 0x90,0x3C,                                        // Note on missing its velocity
+};
+
+static const uint8_t NO_STATUS_FILE[] = {
+    'M','T','h','d', 0,0,0,6, 0,0, 0,1, 0x01,0xE0,
+    'M','T','r','k', 0,0,0,7,
+    0x00, 0x3C,0x64,                                        // Data bytes before any status
+    0x00, 0xFF,0x2F,0x00,
+};
+
+static int check_events(const char *name, const uint8_t *file, size_t len,
+                        const midi_event_t *expect, size_t n, uint64_t end_ns){
+    smf_t s;
+    if(smf_parse(&s, file, len) < 0){
+        printf("%s: parse failed\n", name);
+        return 1;
+    }
+    int errors = 0;
+    if(s.count != n){
+        printf("  %zu events, expected %zu\n", s.count, n);
+        errors++;
+    }
+    for(size_t i=0; i<n && i<s.count; i++){
+        const midi_event_t *g = &s.ev[i], *x = &expect[i];
+        if(g->t_ns != x->t_ns || g->status != x->status || g->data1 != x->data1 || g->data2 != x->data2){
+            printf("  event %zu: %02X %02X %02X at %llu ns, expected %02X %02X %02X at %llu ns\n", i,
+                   g->status, g->data1, g->data2, (unsigned long long)g->t_ns,
+                   x->status, x->data1, x->data2, (unsigned long long)x->t_ns);
+            errors++;
+        }
+    }
+    if(s.end_ns != end_ns){
+        printf("  end at %llu ns, expected %llu ns\n", (unsigned long long)s.end_ns, (unsigned long long)end_ns);
+        errors++;
+    }
+    smf_free(&s);
+    printf("%s: %zu events, %d errors\n", name, n, errors);
+    return errors != 0;
+}
+
+static int check_rejected(const char *name, const uint8_t *file, size_t len){
+    smf_t s;
+    int r = smf_parse(&s, file, len);
+    smf_free(&s);
+    printf("%s: %s\n", name, r < 0 ? "rejected" : "ACCEPTED");
+    return r >= 0;
+}
+
+int main(void){
+    static const midi_event_t smpte_expect[] = {
+        { 0,        0x90, 0x3C, 0x64 },
+        { 250 * MS, 0x80, 0x3C, 0x40 },
+    };
+    int fail = 0;
+    fail |= check_events("Tempo map", TEMPO_FILE, sizeof(TEMPO_FILE),
+                         TEMPO_EXPECT, sizeof(TEMPO_EXPECT) / sizeof(TEMPO_EXPECT[0]), 2500 * MS);
+    fail |= check_events("SMPTE division", SMPTE_FILE, sizeof(SMPTE_FILE), smpte_expect, 2, 250 * MS);
+    fail |= check_rejected("Truncated track", TRUNCATED_FILE, sizeof(TRUNCATED_FILE));
+    fail |= check_rejected("Missing status", NO_STATUS_FILE, sizeof(NO_STATUS_FILE));
+    if(fail){
+        printf("\n*** FAIL ***\n");
+        return 1;
+    }
+    printf("\n*** SUCCESS: MIDI files parse to the expected timed events ***\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Fixed-point vs float SVF comparison
+ *
+ * Drives both filter implementations with the same signal for every mode
+ * across the cutoff/resonance knob range and reports the max/RMS error in
+ * int16 LSBs. A second pass checks stability at full resonance: an impulse
+ * followed by silence must ring down instead of latching or blowing up.
+ *
+ * Build: make test   (host compiler, -DROCKIT_SVF_FIXED)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "filter_svf.h"
+
+#define SR 48000
+#define N_SAMPLES 24000            // 0.5 s per case
+#define MAX_ERR_LSB 1.0            // Allowed peak deviation from the float filter
+#define RING_SECONDS 2
+#define RING_LIMIT_LSB 2           // Extra tail level allowed over the float filter
+
+static const char *MODE_NAMES[4] = { "LP", "BP", "HP", "Notch" };
+
+// Knob grid, including both ends: 127 is where the coefficients come
+// closest to the limits of their fixed-point formats
+static const int CUTOFFS[] = { 0, 21, 42, 63, 84, 105, 120, 127 };
+static const int RESONANCES[] = { 0, 42, 84, 112, 127 };
+#define N_CUTOFFS (int)(sizeof(CUTOFFS) / sizeof(CUTOFFS[0]))
+#define N_RESONANCES (int)(sizeof(RESONANCES) / sizeof(RESONANCES[0]))
+
+static float run_float(svf_t *f, int mode, float x){
+    switch(mode){
+        case 0: return svf_process_lp(f, x);
+        case 1: return svf_process_bp(f, x);
+        case 2: return svf_process_hp(f, x);
+        default: return svf_process_notch(f, x);
+    }
+}
+
+static int32_t run_fixed(svf_t *f, int mode, int32_t x){
+    switch(mode){
+        case 0: return svf_fx_process_lp(f, x);
+        case 1: return svf_fx_process_bp(f, x);
+        case 2: return svf_fx_process_hp(f, x);
+        default: return svf_fx_process_notch(f, x);
+    }
+}
+
+// Band-rich test input: 110 Hz saw plus LCG noise, about -6 dBFS
+static int16_t test_input(int n, uint32_t *seed){
+    int32_t saw = (int32_t)((n * 110 * 65536LL / SR) & 0xFFFF) - 32768;
+    *seed = *seed * 1664525u + 1013904223u;
+    int32_t noise = (int32_t)(*seed >> 16) - 32768;
+    return (int16_t)((saw >> 2) + (noise >> 2));
+}
+
+static void set_knobs(svf_t *f, int cutoff, int res){
+    svf_set_cutoff_param(f, cutoff << 8);
+    svf_set_res_param(f, res << 8);
+    svf_update_fixed(f);
+}
+
+int main(void){
+    static svf_t ff, fx;
+    int failures = 0;
+
+    printf("SVF fixed-point vs float (%d Hz, %d samples per case)\n", SR, N_SAMPLES);
+    printf("%-6s %6s %4s %10s %10s\n", "mode", "cutoff", "res", "max_lsb", "rms_lsb");
+
+    for(int mode = 0; mode < 4; mode++){
+        double worst = 0.0;
+        for(int c = 0; c < N_CUTOFFS; c++){
+            for(int r = 0; r < N_RESONANCES; r++){
+                int cutoff = CUTOFFS[c], res = RESONANCES[r];
+                svf_init(&ff, SR); svf_init(&fx, SR);
+                set_knobs(&ff, cutoff, res); set_knobs(&fx, cutoff, res);
+
+                uint32_t seed = 12345;
+                double max_err = 0.0, sum_sq = 0.0;
+                for(int n = 0; n < N_SAMPLES; n++){
+                    int16_t in = test_input(n, &seed);
+                    float yf = run_float(&ff, mode, (float)in / 32768.0f) * 32768.0f;
+                    double yx = (double)run_fixed(&fx, mode, (int32_t)in << 8) / 256.0;
+                    double err = fabs(yf - yx);
+                    if(err > max_err) max_err = err;
+                    sum_sq += err * err;
+                }
+                double rms = sqrt(sum_sq / N_SAMPLES);
+                printf("%-6s %6d %4d %10.2f %10.3f\n", MODE_NAMES[mode], cutoff, res, max_err, rms);
+                if(max_err > worst) worst = max_err;
+            }
+        }
+        if(worst > MAX_ERR_LSB){
+            printf("FAIL: %s max error %.2f LSB > %.1f\n", MODE_NAMES[mode], worst, MAX_ERR_LSB);
+            failures++;
+        }
+    }
+
+    // Stability at maximum resonance: full-scale impulse, then silence.
+    // The fixed filter must ring down like the float one - no latch-up,
+    // no limit cycle, no saturation runaway.
+    printf("\nStability at res=127 (impulse ring-down, %d s)\n", RING_SECONDS);
+    for(int mode = 0; mode < 4; mode++){
+        int mode_failures = failures;
+        for(int cutoff = 0; cutoff <= 127; cutoff = cutoff == 120 ? 127 : cutoff + 8){
+            svf_init(&ff, SR); svf_init(&fx, SR);
+            set_knobs(&ff, cutoff, 127); set_knobs(&fx, cutoff, 127);
+            int32_t peak = 0, tail_fx = 0, tail_ff = 0;
+            for(int n = 0; n < RING_SECONDS * SR; n++){
+                int16_t in = (n < 4) ? 32767 : 0;
+                int32_t yx = run_fixed(&fx, mode, (int32_t)in << 8) >> 8;
+                int32_t yf = (int32_t)(run_float(&ff, mode, (float)in / 32768.0f) * 32768.0f);
+                if(abs(yx) > peak) peak = abs(yx);
+                if(n >= RING_SECONDS * SR - 1000){
+                    if(abs(yx) > tail_fx) tail_fx = abs(yx);
+                    if(abs(yf) > tail_ff) tail_ff = abs(yf);
+                }
+            }
+            if(tail_fx > tail_ff + RING_LIMIT_LSB){
+                printf("FAIL: %s cutoff %d tail %d LSB vs float %d LSB (peak %d)\n",
+                       MODE_NAMES[mode], cutoff, tail_fx, tail_ff, peak);
+                failures++;
+            }
+        }
+        if(failures == mode_failures) printf("%-6s ok\n", MODE_NAMES[mode]);
+    }
+
+    if(failures){
+        printf("\n*** %d SVF check(s) failed ***\n", failures);
+        return 1;
+    }
+    printf("\n*** SUCCESS: fixed-point SVF matches float within %.1f LSB and is stable ***\n", MAX_ERR_LSB);
+    return 0;
+}
@@ -0,0 +1,292 @@
+/**
+ * WebSocket test (host build)
+ *
+ * Checks the helpers in websocket.c against known answers (SHA-1 vectors,
+ * the RFC 6455 handshake and masked-frame examples, partial and oversized
+ * frames). Given a midi_bridge binary, it then starts it with a MIDI sink
+ * upstream and checks the /ws endpoint end to end: the handshake, a binary
+ * frame forwarded upstream and pushed to the other socket (not back to its
+ * sender), running status and split messages resolved per socket, HTTP /cc
+ * pushed to both sockets, /midi?hex= batches written out in full (and
+ * refused if they would leave the stream mid-message), ping/pong and the
+ * close handshake.
+ *
+ * Usage: test_websocket [MIDI_BRIDGE]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "websocket.h"
+
+#define HTTP_PORT 50331
+#define MIDI_PORT 50332
+
+static int errors;
+
+static void check(int ok, const char *what){
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAIL");
+    if(!ok) errors++;
+}
+
+static void hex(const uint8_t *d, size_t n, char *out){
+    for(size_t i=0; i<n; i++) sprintf(out + 2*i, "%02x", d[i]);
+}
+
+static void test_helpers(void){
+    uint8_t digest[20];
+    char text[64];
+
+    ws_sha1("abc", 3, digest);
+    hex(digest, 20, text);
+    check(strcmp(text, "a9993e364706816aba3e25717850c26c9cd0d89d") == 0, "SHA-1 \"abc\"");
+    ws_sha1("", 0, digest);
+    hex(digest, 20, text);
+    check(strcmp(text, "da39a3ee5e6b4b0d3255bfef95601890afd80709") == 0, "SHA-1 empty");
+    const char *two = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";   // 56 bytes: two final blocks
+    ws_sha1(two, strlen(two), digest);
+    hex(digest, 20, text);
+    check(strcmp(text, "84983e441c3bd26ebaae4aa1f95129e5e54670f1") == 0, "SHA-1 56-byte message");
+
+    ws_base64((const uint8_t *)"Ma", 2, text);
+    check(strcmp(text, "TWE=") == 0, "base64 padding");
+
+    char accept[WS_ACCEPT_LEN + 1];
+    ws_accept_key("dGhlIHNhbXBsZSBub25jZQ==", 24, accept);
+    check(strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0, "RFC 6455 accept key");
+
+    // RFC 6455 5.7: masked "Hello"
+    uint8_t hello[] = { 0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58 };
+    ws_frame_t f;
+    int n = ws_parse_frame(hello, 5, 1024, &f);
+    check(n == 0, "partial frame waits for more");
+    n = ws_parse_frame(hello, sizeof(hello), 1024, &f);
+    check(n == (int)sizeof(hello) && f.fin && f.opcode == WS_TEXT && f.len == 5 &&
+          memcmp(f.payload, "Hello", 5) == 0, "masked text frame unmasks in place");
+
+    uint8_t unmasked[] = { 0x82, 0x03, 0xB0, 0x4A, 0x10 };
+    check(ws_parse_frame(unmasked, sizeof(unmasked), 1024, &f) == WS_ERR_PROTOCOL, "unmasked client frame rejected");
+
+    uint8_t big[8] = { 0x82, 0xFE, 0x08, 0x00 };    // 2048 bytes, 16-bit length
+    check(ws_parse_frame(big, sizeof(big), 1024, &f) == WS_ERR_TOO_BIG, "oversized frame rejected");
+
+    uint8_t head[WS_HEADER_MAX];
+    check(ws_frame_header(head, WS_BINARY, 3) == 2 && head[0] == 0x82 && head[1] == 3, "short server header");
+    check(ws_frame_header(head, WS_BINARY, 300) == 4 && head[1] == 126 && head[2] == 1 && head[3] == 44, "16-bit length header");
+}
+
+static int connect_port(int port){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons((uint16_t)port);
+    struct timeval tv = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if(connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int read_exact(int fd, void *buf, size_t n){
+    size_t got = 0;
+    while(got < n){
+        ssize_t r = read(fd, (char *)buf + got, n - got);
+        if(r <= 0) return -1;
+        got += (size_t)r;
+    }
+    return 0;
+}
+
+// Handshake; returns the socket, or -1 if the accept key is wrong
+static int ws_open(void){
+    int fd = connect_port(HTTP_PORT);
+    if(fd < 0) return -1;
+    const char *req = "GET /ws HTTP/1.1\r\nHost: test\r\nUpgrade: websocket\r\nConnection: keep-alive, Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    char resp[512];
+    size_t n = 0;
+    if(write(fd, req, strlen(req)) != (ssize_t)strlen(req)) return -1;
+    while(n < sizeof(resp) - 1){      // Byte at a time: stop exactly at the end of the headers
+        if(read(fd, resp + n, 1) != 1) break;
+        resp[++n] = '\0';
+        if(n >= 4 && memcmp(resp + n - 4, "\r\n\r\n", 4) == 0) break;
+    }
+    if(strncmp(resp, "HTTP/1.1 101", 12) != 0 || !strstr(resp, "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=")){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int ws_send(int fd, int opcode, const uint8_t *payload, size_t len){
+    uint8_t frame[64] = { (uint8_t)(0x80 | opcode), (uint8_t)(0x80 | len), 0x12, 0x34, 0x56, 0x78 };
+    for(size_t i=0; i<len; i++) frame[6 + i] = payload[i] ^ frame[2 + (i & 3)];
+    return write(fd, frame, 6 + len) == (ssize_t)(6 + len) ? 0 : -1;
+}
+
+// Read one short server frame; returns its payload length, or -1
+static int ws_recv(int fd, int *opcode, uint8_t *payload){
+    uint8_t head[2];
+    if(read_exact(fd, head, 2) < 0 || (head[1] & 0x80) || (head[1] & 0x7F) > 125) return -1;
+    *opcode = head[0] & 0x0F;
+    int len = head[1] & 0x7F;
+    return read_exact(fd, payload, (size_t)len) < 0 ? -1 : len;
+}
+
+// Nothing arrives within 200 ms
+static int ws_quiet(int fd){
+    struct timeval tv = { 0, 200000 }, back = { 2, 0 };
+    uint8_t b;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ssize_t r = read(fd, &b, 1);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &back, sizeof(back));
+    return r < 0;
+}
+
+// One HTTP request on its own connection; returns the status code, or -1
+static int http_get(const char *path){
+    int fd = connect_port(HTTP_PORT);
+    if(fd < 0) return -1;
+    char req[256], resp[64];
+    int len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nConnection: close\r\n\r\n", path);
+    int code = -1;
+    if(write(fd, req, (size_t)len) == len && read(fd, resp, sizeof(resp) - 1) > 12) sscanf(resp, "HTTP/1.1 %d", &code);
+    close(fd);
+    return code;
+}
+
+static void test_bridge(const char *bridge){
+    int lfd = socket(AF_INET, SOCK_STREAM, 0), one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    a.sin_port = htons(MIDI_PORT);
+    if(bind(lfd, (struct sockaddr *)&a, sizeof(a)) < 0 || listen(lfd, 1) < 0){
+        perror("sink");
+        errors++;
+        return;
+    }
+
+    char hp[16], mp[16];
+    snprintf(hp, sizeof(hp), "%d", HTTP_PORT);
+    snprintf(mp, sizeof(mp), "%d", MIDI_PORT);
+    pid_t pid = fork();
+    if(pid == 0){
+        int null = open("/dev/null", O_WRONLY);
+        if(null >= 0) dup2(null, 2);
+        execl(bridge, bridge, "--port", hp, "--midi-port", mp, (char *)NULL);
+        _exit(127);
+    }
+
+    int wa = -1, wb = -1;
+    for(int i=0; i<100 && wa < 0; i++){
+        usleep(20000);
+        wa = ws_open();
+    }
+    wb = ws_open();
+    check(wa >= 0 && wb >= 0, "handshake returns the RFC accept key");
+    if(wa < 0 || wb < 0) goto done;
+
+    // Binary frame: forwarded upstream, pushed to the other socket only,
+    // with running status written out
+    uint8_t msg[5] = { 0xB0, 74, 20, 75, 30 }, full[6] = { 0xB0, 74, 20, 0xB0, 75, 30 }, got[128];
+    int op, n, ok;
+    check(ws_send(wa, WS_BINARY, msg, 5) == 0, "send binary MIDI frame");
+    int up = accept(lfd, NULL, NULL);
+    struct timeval tv = { 2, 0 };
+    setsockopt(up, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    check(up >= 0 && read_exact(up, got, 6) == 0 && memcmp(got, full, 6) == 0, "frame forwarded upstream in one piece");
+    n = ws_recv(wb, &op, got);
+    check(n == 6 && op == WS_BINARY && memcmp(got, full, 6) == 0, "frame pushed to the other socket");
+    check(ws_quiet(wa), "not echoed to its sender");
+
+    // Each socket has its own running status: wb's bare data bytes must not
+    // complete wa's CC, and a message split across frames goes out whole
+    uint8_t bare[2] = { 75, 30 }, note[2] = { 0x90, 60 }, vel[1] = { 100 };
+    uint8_t expect[6] = { 0xB0, 75, 30, 0x90, 60, 100 };
+    ws_send(wb, WS_BINARY, bare, 2);
+    ws_send(wa, WS_BINARY, bare, 2);
+    ws_send(wa, WS_BINARY, note, 2);
+    ws_send(wa, WS_BINARY, vel, 1);
+    check(read_exact(up, got, 6) == 0 && memcmp(got, expect, 6) == 0, "upstream gets whole messages with status");
+    n = ws_recv(wb, &op, got);
+    ok = n == 3 && memcmp(got, expect, 3) == 0;
+    n = ws_recv(wb, &op, got);
+    check(ok && n == 3 && memcmp(got, expect + 3, 3) == 0, "peers get whole messages with status");
+
+    // HTTP on a third connection reaches both sockets
+    int h = connect_port(HTTP_PORT);
+    const char *req = "GET /cc?cc=71&value=99 HTTP/1.1\r\nConnection: close\r\n\r\n";
+    if(h >= 0 && write(h, req, strlen(req)) != (ssize_t)strlen(req)) h = -1;
+    uint8_t cc[3] = { 0xB0, 71, 99 };
+    n = ws_recv(wa, &op, got);
+    ok = n == 3 && memcmp(got, cc, 3) == 0;
+    n = ws_recv(wb, &op, got);
+    check(h >= 0 && ok && n == 3 && memcmp(got, cc, 3) == 0, "HTTP /cc pushed to every socket");
+    if(h >= 0) close(h);
+
+    // Batches: bare data bytes or a cut-off message would attach to another
+    // sender's status on the shared upstream stream
+    read_exact(up, got, 3);                 // The /cc above
+    check(http_get("/midi?hex=3c64") == 400, "/midi batch starting with data refused");
+    check(http_get("/midi?hex=903c643e") == 400, "/midi batch ending mid-message refused");
+    uint8_t batch[6] = { 0x90, 0x3c, 0x64, 0x90, 0x3e, 0x64 };
+    check(http_get("/midi?hex=903c643e64") == 200 && read_exact(up, got, 6) == 0 && memcmp(got, batch, 6) == 0,
+          "/midi batch forwarded with status written out");
+    n = ws_recv(wa, &op, got);
+    check(n == 6 && memcmp(got, batch, 6) == 0, "/midi batch pushed the same way");
+    ws_recv(wb, &op, got);
+
+    ws_send(wa, WS_PING, (const uint8_t *)"hi", 2);
+    n = ws_recv(wa, &op, got);
+    check(n == 2 && op == WS_PONG && memcmp(got, "hi", 2) == 0, "ping answered with pong");
+
+    uint8_t code[2] = { 0x03, 0xE8 };     // 1000
+    ws_send(wb, WS_CLOSE, code, 2);
+    n = ws_recv(wb, &op, got);
+    check(n == 2 && op == WS_CLOSE && got[0] == 0x03 && got[1] == 0xE8, "close echoed");
+    check(read(wb, got, 1) == 0, "connection closed after close frame");
+
+    ws_send(wa, WS_TEXT, (const uint8_t *)"x", 1);
+    n = ws_recv(wa, &op, got);
+    check(n == 2 && op == WS_CLOSE && got[0] == 0x03 && got[1] == 0xEB, "text frame closes with 1003");
+
+    if(up >= 0) close(up);
+done:
+    if(wa >= 0) close(wa);
+    if(wb >= 0) close(wb);
+    close(lfd);
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, char **argv){
+    signal(SIGPIPE, SIG_IGN);
+    printf("WebSocket helpers:\n");
+    test_helpers();
+    if(argc > 1){
+        printf("Bridge /ws endpoint (%s):\n", argv[1]);
+        test_bridge(argv[1]);
+    }
+
+    if(errors){
+        printf("\n*** FAIL: %d checks ***\n", errors);
+        return 1;
+    }
+    printf("\n*** SUCCESS: WebSocket handshake and MIDI frames work ***\n");
+    return 0;
+}
@@ -0,0 +1,37 @@
+// termios2 line rates, see uart_baud.h
+
+#include "uart_baud.h"
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <asm/termbits.h>   // struct termios2, BOTHER
+#include <asm/ioctls.h>     // TCGETS2, TCSETS2
+#endif
+
+int uart_baud_set(int fd, unsigned baud){
+#if defined(__linux__) && defined(TCSETS2) && defined(BOTHER)
+    struct termios2 t;
+    if(ioctl(fd, TCGETS2, &t) < 0) return -1;
+    t.c_cflag = (t.c_cflag & ~CBAUD) | BOTHER;
+    t.c_cflag &= ~(CBAUD << IBSHIFT);      // Input rate follows the output rate
+    t.c_ospeed = t.c_ispeed = baud;
+    if(ioctl(fd, TCSETS2, &t) < 0) return -1;
+
+    // Drivers that cannot divide down to the rate quietly pick another
+    unsigned actual = uart_baud_get(fd);
+    return actual * 100 >= baud * 98 && actual * 100 <= baud * 102 ? 0 : -1;
+#else
+    (void)fd; (void)baud;
+    return -1;
+#endif
+}
+
+unsigned uart_baud_get(int fd){
+#if defined(__linux__) && defined(TCGETS2)
+    struct termios2 t;
+    if(ioctl(fd, TCGETS2, &t) < 0) return 0;
+    return t.c_ospeed;
+#else
+    (void)fd;
+    return 0;
+#endif
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/*
+ * Arbitrary UART line rates through termios2 (TCSETS2 with BOTHER), which
+ * most current Linux serial drivers honour. Kept apart from the termios.h
+ * users: the kernel's struct termios2 and libc's termios headers cannot be
+ * included together.
+ */
+
+// Set the line to baud (raw settings already applied with tcsetattr());
+// returns 0 if the driver runs within 2% of it, -1 otherwise
+int uart_baud_set(int fd, unsigned baud);
+
+// Rate the line runs at, or 0 if it cannot be read
+unsigned uart_baud_get(int fd);
@@ -0,0 +1,134 @@
+// Minimal WebSocket server helpers, see websocket.h
+
+#include "websocket.h"
+#include <string.h>
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+static uint32_t rol(uint32_t x, int n){
+    return (x << n) | (x >> (32 - n));
+}
+
+static void sha1_block(uint32_t h[5], const uint8_t *p){
+    uint32_t w[80];
+    for(int i=0; i<16; i++)
+        w[i] = (uint32_t)p[4*i] << 24 | (uint32_t)p[4*i+1] << 16 | (uint32_t)p[4*i+2] << 8 | p[4*i+3];
+    for(int i=16; i<80; i++) w[i] = rol(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for(int i=0; i<80; i++){
+        uint32_t f, k;
+        if(i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if(i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if(i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else            { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        uint32_t t = rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol(b, 30);
+        b = a;
+        a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
+
+void ws_sha1(const void *data, size_t len, uint8_t digest[20]){
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    const uint8_t *p = (const uint8_t *)data;
+    size_t left = len;
+    for(; left >= 64; left -= 64, p += 64) sha1_block(h, p);
+
+    // Final one or two blocks: tail, 0x80, zeros, bit length (big-endian)
+    uint8_t tail[128];
+    size_t n = left < 56 ? 64 : 128;
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, p, left);
+    tail[left] = 0x80;
+    uint64_t bits = (uint64_t)len * 8;
+    for(int i=0; i<8; i++) tail[n - 1 - i] = (uint8_t)(bits >> (8 * i));
+    for(size_t off=0; off<n; off+=64) sha1_block(h, tail + off);
+
+    for(int i=0; i<5; i++){
+        digest[4*i]   = (uint8_t)(h[i] >> 24);
+        digest[4*i+1] = (uint8_t)(h[i] >> 16);
+        digest[4*i+2] = (uint8_t)(h[i] >> 8);
+        digest[4*i+3] = (uint8_t)h[i];
+    }
+}
+
+size_t ws_base64(const uint8_t *in, size_t len, char *out){
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    for(size_t i=0; i<len; i+=3){
+        uint32_t v = (uint32_t)in[i] << 16;
+        if(i + 1 < len) v |= (uint32_t)in[i+1] << 8;
+        if(i + 2 < len) v |= in[i+2];
+        out[n++] = ALPHABET[v >> 18 & 63];
+        out[n++] = ALPHABET[v >> 12 & 63];
+        out[n++] = i + 1 < len ? ALPHABET[v >> 6 & 63] : '=';
+        out[n++] = i + 2 < len ? ALPHABET[v & 63] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+void ws_accept_key(const char *key, size_t key_len, char accept[WS_ACCEPT_LEN + 1]){
+    char buf[128];
+    uint8_t digest[20];
+    if(key_len > sizeof(buf) - sizeof(WS_GUID)) key_len = sizeof(buf) - sizeof(WS_GUID);
+    memcpy(buf, key, key_len);
+    memcpy(buf + key_len, WS_GUID, sizeof(WS_GUID) - 1);
+    ws_sha1(buf, key_len + sizeof(WS_GUID) - 1, digest);
+    ws_base64(digest, sizeof(digest), accept);
+}
+
+int ws_parse_frame(uint8_t *buf, size_t len, size_t max_payload, ws_frame_t *f){
+    if(len < 2) return 0;
+    if(buf[0] & 0x70) return WS_ERR_PROTOCOL;           // RSV bits: no extensions negotiated
+    if(!(buf[1] & 0x80)) return WS_ERR_PROTOCOL;        // Clients must mask
+
+    f->fin = buf[0] >> 7;
+    f->opcode = buf[0] & 0x0F;
+    uint64_t plen = buf[1] & 0x7F;
+    size_t head = 2;
+    if(plen == 126){
+        if(len < 4) return 0;
+        plen = (uint64_t)buf[2] << 8 | buf[3];
+        head = 4;
+    } else if(plen == 127){
+        if(len < 10) return 0;
+        plen = 0;
+        for(int i=0; i<8; i++) plen = plen << 8 | buf[2 + i];
+        head = 10;
+    }
+    if((f->opcode & 0x8) && (plen > 125 || !f->fin)) return WS_ERR_PROTOCOL;
+    if(plen > max_payload) return WS_ERR_TOO_BIG;
+    if(len < head + 4 + plen) return 0;
+
+    const uint8_t *mask = buf + head;
+    f->payload = buf + head + 4;
+    f->len = (size_t)plen;
+    for(size_t i=0; i<f->len; i++) f->payload[i] ^= mask[i & 3];
+    return (int)(head + 4 + plen);
+}
+
+size_t ws_frame_header(uint8_t out[WS_HEADER_MAX], int opcode, size_t len){
+    out[0] = (uint8_t)(0x80 | opcode);
+    if(len < 126){
+        out[1] = (uint8_t)len;
+        return 2;
+    }
+    if(len < 65536){
+        out[1] = 126;
+        out[2] = (uint8_t)(len >> 8);
+        out[3] = (uint8_t)len;
+        return 4;
+    }
+    out[1] = 127;
+    for(int i=0; i<8; i++) out[2 + i] = (uint8_t)((uint64_t)len >> (8 * (7 - i)));
+    return 10;
+}
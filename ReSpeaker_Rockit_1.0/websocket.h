@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Minimal server side of RFC 6455 WebSocket for midi_bridge: the opening
+ * handshake key (SHA-1 + base64, no crypto library on the board), parsing
+ * masked client frames in place, and headers for unmasked server frames.
+ * Fragmented messages are not reassembled; callers reject FIN=0 frames.
+ */
+
+enum {
+    WS_CONT = 0x0,
+    WS_TEXT = 0x1,
+    WS_BINARY = 0x2,
+    WS_CLOSE = 0x8,
+    WS_PING = 0x9,
+    WS_PONG = 0xA,
+};
+
+#define WS_ERR_PROTOCOL -1  // Unmasked client frame, reserved bits, bad control frame
+#define WS_ERR_TOO_BIG -2   // Payload longer than the caller allows
+
+#define WS_ACCEPT_LEN 28    // base64 of a SHA-1 digest
+#define WS_HEADER_MAX 10    // Longest server frame header
+
+typedef struct {
+    int fin;
+    int opcode;
+    uint8_t *payload;       // Points into the parsed buffer, already unmasked
+    size_t len;
+} ws_frame_t;
+
+void ws_sha1(const void *data, size_t len, uint8_t digest[20]);
+
+// Encode len bytes; writes 4 * ((len + 2) / 3) characters plus a NUL,
+// returns the character count
+size_t ws_base64(const uint8_t *in, size_t len, char *out);
+
+// Sec-WebSocket-Accept for the client's Sec-WebSocket-Key
+void ws_accept_key(const char *key, size_t key_len, char accept[WS_ACCEPT_LEN + 1]);
+
+// Parse one client frame from buf and unmask its payload in place. Returns
+// the bytes the frame occupies, 0 if it is not complete yet, or WS_ERR_*.
+int ws_parse_frame(uint8_t *buf, size_t len, size_t max_payload, ws_frame_t *f);
+
+// Header of a final, unmasked server frame; returns its length
+size_t ws_frame_header(uint8_t out[WS_HEADER_MAX], int opcode, size_t len);
@@ -6,9 +6,11 @@ import socket
 import struct
 import time
 
-# --- TCP config (must match respeaker_rockit) ---
-TCP_HOST = "127.0.0.1"
-TCP_PORT = 50000
+# --- MIDI config (must match respeaker_rockit) ---
+# One UDP datagram per message: no connection setup per note
+MIDI_HOST = "127.0.0.1"
+MIDI_PORT = 50000
+midi_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
 
 # --- MIDI message constants ---
 MIDI_NOTE_ON  = 0x90
@@ -17,15 +19,11 @@ MIDI_CC       = 0xB0
 
 def send_raw_midi(status, data1, data2):
     msg = struct.pack("BBB", status, data1, data2)
-    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
     try:
-        s.connect((TCP_HOST, TCP_PORT))
-        s.sendall(msg)
+        midi_sock.sendto(msg, (MIDI_HOST, MIDI_PORT))
         print("-> MIDI: %02X %3d %3d" % (status, data1, data2))
     except IOError as e:
         print("socket error:", e)
-    finally:
-        s.close()
 
 def send_midi_note(note, velocity=100, duration=0.5):
     send_raw_midi(MIDI_NOTE_ON, note, velocity)